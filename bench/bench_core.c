@@ -0,0 +1,350 @@
+/**
+ * @file bench_core.c
+ * @brief Microbenchmarks of the block and field primitives.
+ *
+ * Each primitive is timed on a corpus of boards (empty, mid-stack, near top-out) with every block type
+ * and rotation, and the results are printed as JSON, in nanoseconds per operation. The snapshots of a
+ * board taken by a search, a copy of a Field or of a GameState, are timed too, and so is the extraction
+ * of the board features with each kernel supported by the CPU, in nanoseconds per board.
+ *
+ * Usage: bench_core [-n iterations] [-o file].
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shared.h"
+#include "field.h"
+#include "block.h"
+#include "feature.h"
+
+
+#define DEFAULT_ITERATIONS 200000 /**< @brief Default number of operations per measure. */
+#define REPETITIONS 5 /**< @brief Number of measures per benchmark: the fastest one is reported. */
+#define BOARDS 3 /**< @brief Number of boards of the corpus. */
+#define CORPUS_SEED 2017 /**< @brief Seed of the random number generator of the corpus. */
+#define CONFIGS (I_SHORT*4) /**< @brief Number of couples (block type, rotation). */
+#define SNAPSHOTS 64 /**< @brief Number of snapshots written in turn, as the nodes of a search. */
+
+/**
+ * @enum op
+ * @brief Benchmarked operations.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum op {
+    OP_CAN_MOVE_BLOCK,
+    OP_CAN_ROTATE_BLOCK,
+    OP_MOVE_BLOCK,
+    OP_WRITE_BLOCK,
+    OP_FIND_ROW_FIELD,
+    OP_CLEAR_ROW_FIELD,
+    OP_HARD_DROP,
+    OP_COPY_FIELD,
+    OP_COPY_STATE,
+    OP_FEATURES_SCALAR,
+    OP_FEATURES_SSE2,
+    OP_FEATURES_AVX2,
+    OPS
+};
+
+/**
+ * @brief Names of the operations, in the order of enum op.
+ */
+static const char *OP_NAMES[] = {
+    "can_move_block",
+    "can_rotate_block",
+    "move_block",
+    "write_block",
+    "find_row_field",
+    "clear_row_field",
+    "hard_drop",
+    "copy_field",
+    "copy_state",
+    "features_scalar",
+    "features_sse2",
+    "features_avx2"
+};
+
+/**
+ * @brief Names of the boards of the corpus.
+ */
+static const char *BOARD_NAMES[BOARDS] = {
+    "empty",
+    "mid_stack",
+    "near_top_out"
+};
+
+/**
+ * @brief Number of filled rows of each board of the corpus.
+ */
+static const int BOARD_HEIGHTS[BOARDS] = {0, 10, 17};
+
+static Field *corpus[BOARDS]; /**< @brief Boards of the corpus. */
+static Field templates[BOARDS]; /**< @brief Copies of the boards, to restore them after the operations that modify them. */
+static Block blocks[BOARDS][CONFIGS]; /**< @brief Blocks at the spawn position of each board. */
+static GameState states[BOARDS]; /**< @brief Compact states with the boards of the corpus. */
+static Field field_snapshots[SNAPSHOTS]; /**< @brief Copies of the boards. */
+static GameState state_snapshots[SNAPSHOTS]; /**< @brief Copies of the compact states. */
+static BoardBatch batches[BOARDS]; /**< @brief Batches of copies of each board of the corpus. */
+static FeatureBatch features; /**< @brief Features of a batch. */
+static volatile long sink; /**< @brief Results of the operations, so that they are not optimized away. */
+
+/**
+ * @brief Fill the bottom rows of a field with random cells, leaving at least one hole per row.
+ *
+ * @param f field pointer.
+ * @param height number of rows to fill.
+ * @param seed random number generator state.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void fill_field(Field *f, int height, unsigned int *seed) {
+    int row, col;
+    for (row = ROWS - height; row < ROWS; row++) {
+        for (col = 0; col < COLUMNS; col++) {
+            // 3 cells out of 4 are filled, as in a real stack
+            f->grid[row][col] = (rand_r(seed) % 4 != 0) ? rand_r(seed) % I_SHORT + 1 : BG;
+        }
+        f->grid[row][rand_r(seed) % COLUMNS] = BG;
+    }
+}
+
+/**
+ * @brief Create the boards of the corpus and the blocks at their spawn position.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_corpus() {
+    unsigned int seed = CORPUS_SEED;
+    int i, c, row, col;
+    for (i = 0; i < BOARDS; i++) {
+        corpus[i] = create_field();
+        init_field(corpus[i], ROWS, COLUMNS);
+        fill_field(corpus[i], BOARD_HEIGHTS[i], &seed);
+        templates[i] = *corpus[i];
+        for (row = 0; row < ROWS; row++) {
+            for (col = 0; col < COLUMNS; col++) {
+                if (corpus[i]->grid[row][col] != BG) {
+                    states[i].board[row] |= 1 << col;
+                }
+            }
+            for (c = 0; c < BATCH_SIZE; c++) {
+                batches[i].rows[row][c] = states[i].board[row];
+            }
+        }
+        for (c = 0; c < CONFIGS; c++) {
+            Block *b = &blocks[i][c];
+            // same spawn position as in the game
+            init_block(b, c / 4 + 1, c % 4, -BLOCK_MAX_SIZE, COLUMNS / 2);
+            while (get_limit_high_block(b) < 0 && can_move_block(b, corpus[i], DOWN)) {
+                b->row++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Return nanoseconds elapsed since a given time.
+ *
+ * @param start start time.
+ * @return elapsed nanoseconds.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long elapsed_nanos(struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec)*1000000000L + (now.tv_nsec - start->tv_nsec);
+}
+
+/**
+ * @brief Run an operation a given number of times on a board.
+ *
+ * @param op operation (enum op).
+ * @param board board index.
+ * @param iterations number of operations.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void run_op(int op, int board, long iterations) {
+    Field *f = corpus[board];
+    Block *b;
+    long i, acc = 0;
+    switch (op) {
+        case OP_CAN_MOVE_BLOCK:
+            for (i = 0; i < iterations; i++) {
+                acc += can_move_block(&blocks[board][i % CONFIGS], f, i % 3);
+            }
+            break;
+        case OP_CAN_ROTATE_BLOCK:
+            for (i = 0; i < iterations; i++) {
+                acc += can_rotate_block(&blocks[board][i % CONFIGS], f);
+            }
+            break;
+        case OP_MOVE_BLOCK:
+            // left and right moves alternate, so that the block does not leave the board
+            for (i = 0; i < iterations; i += 2) {
+                b = &blocks[board][(i / 2) % CONFIGS];
+                move_block(b, f, LEFT);
+                move_block(b, f, RIGHT);
+            }
+            break;
+        case OP_WRITE_BLOCK:
+            for (i = 0; i < iterations; i++) {
+                write_block(&blocks[board][i % CONFIGS], f);
+            }
+            for (i = 0; i < CONFIGS; i++) {
+                erase_block(&blocks[board][i], f);
+            }
+            break;
+        case OP_FIND_ROW_FIELD:
+            // no row is complete: the whole board is scanned
+            for (i = 0; i < iterations; i++) {
+                acc += find_row_field(f, 0, ROWS - 1);
+            }
+            break;
+        case OP_CLEAR_ROW_FIELD:
+            // the cost does not depend on the content: clearing the bottom row moves the whole board
+            for (i = 0; i < iterations; i++) {
+                clear_row_field(f, ROWS - 1);
+            }
+            break;
+        case OP_HARD_DROP:
+            for (i = 0; i < iterations; i++) {
+                // same moves as the fall of the game
+                Block drop = blocks[board][i % CONFIGS];
+                write_block(&drop, f);
+                while (can_move_block(&drop, f, DOWN)) {
+                    move_block(&drop, f, DOWN);
+                }
+                acc += drop.row;
+                erase_block(&drop, f);
+            }
+            break;
+        case OP_COPY_FIELD:
+            for (i = 0; i < iterations; i++) {
+                field_snapshots[i % SNAPSHOTS] = *f;
+            }
+            acc += field_snapshots[0].grid[ROWS - 1][0];
+            break;
+        case OP_COPY_STATE:
+            for (i = 0; i < iterations; i++) {
+                state_snapshots[i % SNAPSHOTS] = states[board];
+            }
+            acc += state_snapshots[0].board[ROWS - 1];
+            break;
+        case OP_FEATURES_SCALAR:
+        case OP_FEATURES_SSE2:
+        case OP_FEATURES_AVX2:
+            // an operation is a board: a batch counts for BATCH_SIZE of them
+            for (i = 0; i < iterations; i += BATCH_SIZE) {
+                extract_features(&batches[board], BATCH_SIZE, &features);
+                acc += features.holes[0];
+            }
+            break;
+    }
+    sink = acc;
+}
+
+/**
+ * @brief Restore a board of the corpus after an operation that modified it.
+ *
+ * @param board board index.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void reset_board(int board) {
+    *corpus[board] = templates[board];
+}
+
+/**
+ * @brief Benchmark routine.
+ *
+ * @param argc number of arguments.
+ * @param argv arguments.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+int main(int argc, char *argv[]) {
+    long iterations = DEFAULT_ITERATIONS;
+    FILE *out = stdout;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:o:")) != -1) {
+        if (opt == 'n' && atol(optarg) > 0) {
+            iterations = atol(optarg);
+        }
+        else if (opt == 'o') {
+            out = fopen(optarg, "w");
+            if (out == NULL) {
+                ERROR_EXIT("fopen");
+            }
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-n iterations] [-o file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    init_corpus();
+
+    fprintf(out, "{\n  \"benchmark\": \"bench_core\",\n  \"iterations\": %ld,\n  \"results\": [", iterations);
+    int op, board, r;
+    bool first = true;
+    for (op = OP_CAN_MOVE_BLOCK; op < OPS; op++) {
+        if (op >= OP_FEATURES_SCALAR && !set_kernel_feature(KERNEL_SCALAR + op - OP_FEATURES_SCALAR)) {
+            continue;
+        }
+        for (board = 0; board < BOARDS; board++) {
+            // warm up
+            run_op(op, board, iterations / 10 + 1);
+            reset_board(board);
+            long best = -1;
+            for (r = 0; r < REPETITIONS; r++) {
+                struct timespec start;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                run_op(op, board, iterations);
+                long nanos = elapsed_nanos(&start);
+                if (best < 0 || nanos < best) {
+                    best = nanos;
+                }
+                reset_board(board);
+            }
+            fprintf(out, "%s\n    {\"op\": \"%s\", \"board\": \"%s\", \"ns_per_op\": %.3f}",
+                    first ? "" : ",", OP_NAMES[op], BOARD_NAMES[board], (double)best / iterations);
+            first = false;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    for (board = 0; board < BOARDS; board++) {
+        delete_field(corpus[board]);
+    }
+    return EXIT_SUCCESS;
+}
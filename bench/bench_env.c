@@ -0,0 +1,159 @@
+/**
+ * @file bench_env.c
+ * @brief Benchmark of the vectorised environment: steps per second from 1 to N threads.
+ *
+ * The environment steps a batch of fixed-seed games, written in shared memory as for a trainer in
+ * another process, with a random legal action per game, chosen from the observations as a trainer
+ * does. For each number of threads, the throughput in steps (placed blocks) per second is reported with
+ * the scaling efficiency, as JSON.
+ *
+ * Usage: bench_env [-t max_threads] [-e envs] [-s steps] [-o file].
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shared.h"
+#include "vec_env.h"
+
+
+#define DEFAULT_ENVS 256 /**< @brief Default number of games stepped at once. */
+#define DEFAULT_STEPS 200 /**< @brief Default number of steps of a run. */
+#define BENCH_SEED 2017 /**< @brief Seed of the first game, and of the actions. */
+
+/**
+ * @struct Result
+ * @brief Result of a run.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int threads; /**< @brief Number of threads. */
+    long steps; /**< @brief Number of steps of all the games. */
+    long games; /**< @brief Number of ended games. */
+    double seconds; /**< @brief Wall-clock time. */
+} Result;
+
+static int envs = DEFAULT_ENVS; /**< @brief Number of games stepped at once. */
+static int steps = DEFAULT_STEPS; /**< @brief Number of steps of a run. */
+
+/**
+ * @brief Step the games on a given number of threads.
+ *
+ * @param threads number of threads.
+ * @return result of the run.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static Result run(int threads) {
+    Result r = {threads, (long)envs*steps, 0, 0};
+    unsigned int *seeds = malloc(envs*sizeof(unsigned int));
+    int *actions = malloc(envs*sizeof(int));
+    if (seeds == NULL || actions == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    int i, n;
+    for (i = 0; i < envs; i++) {
+        seeds[i] = BENCH_SEED + i;
+    }
+    int fd;
+    void *buffer = map_shared_vec_env(envs, &fd);
+    VecEnv *v = create_vec_env(envs, seeds, threads, buffer);
+    Observation *obs = get_observations_vec_env(v);
+    uint8_t *dones = get_dones_vec_env(v);
+    unsigned int seed = BENCH_SEED;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < steps; n++) {
+        for (i = 0; i < envs; i++) {
+            do {
+                actions[i] = rand_r(&seed) % VEC_ENV_ACTIONS;
+            } while (!obs[i].legal[actions[i]]);
+        }
+        step_vec_env(v, actions);
+        for (i = 0; i < envs; i++) {
+            r.games += dones[i];
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    delete_vec_env(v);
+    unmap_shared_vec_env(buffer, envs, fd);
+    free(actions);
+    free(seeds);
+    r.seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return r;
+}
+
+/**
+ * @brief Benchmark routine.
+ *
+ * @param argc number of arguments.
+ * @param argv arguments.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+int main(int argc, char *argv[]) {
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    FILE *out = stdout;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:e:s:o:")) != -1) {
+        if (opt == 't' && atoi(optarg) > 0) {
+            max_threads = atoi(optarg);
+        }
+        else if (opt == 'e' && atoi(optarg) > 0 && atoi(optarg) <= VEC_ENV_MAX_ENVS) {
+            envs = atoi(optarg);
+        }
+        else if (opt == 's' && atoi(optarg) > 0) {
+            steps = atoi(optarg);
+        }
+        else if (opt == 'o') {
+            out = fopen(optarg, "w");
+            if (out == NULL) {
+                ERROR_EXIT("fopen");
+            }
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-t max_threads] [-e envs] [-s steps] [-o file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (max_threads > POOL_MAX_THREADS) {
+        max_threads = POOL_MAX_THREADS;
+    }
+
+    fprintf(out, "{\n  \"benchmark\": \"bench_env\",\n  \"envs\": %d,\n  \"steps\": %d,\n  \"results\": [", envs, steps);
+    double base = 0;
+    int t;
+    for (t = 1; t <= max_threads; t++) {
+        Result r = run(t);
+        double sps = r.steps / r.seconds;
+        if (t == 1) {
+            base = sps;
+        }
+        fprintf(out, "%s\n    {\"threads\": %d, \"steps\": %ld, \"games\": %ld, \"seconds\": %.3f, \"steps_per_sec\": %.0f, \"efficiency\": %.3f}",
+                t == 1 ? "" : ",", t, r.steps, r.games, r.seconds, sps, sps / (t*base));
+        fflush(out);
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,309 @@
+/**
+ * @file bench_games.c
+ * @brief End-to-end benchmark: complete games played by the bot, from 1 to N threads.
+ *
+ * Every thread plays the same fixed-seed games, through the whole cycle of the game: placement, lock,
+ * row deletion, score and drop of the next block. For each number of threads the throughput in blocks
+ * and games per second is reported with the scaling efficiency, as JSON, and can be compared against
+ * a baseline written by a previous run. With -k, the blocks are placed by the beam-search planner,
+ * whose layers are expanded by -x threads each. With -e, they are placed by the expectimax planner, which
+ * searches the -e best placements of each block and shares the placements of the falling block among -x
+ * threads, with a transposition table of -m MiB. With -r, they are placed by the rollout planner, which
+ * plays -r greedy continuations of -l blocks from each of the -e best placements (all of them by default)
+ * on -x threads.
+ *
+ * Usage: bench_games [-t max_threads] [-g games_per_thread] [-p max_pieces] [-d depth] [-k width | -e branching [-m megabytes] | -r rollouts [-l length]] [-x threads] [-o file] [-b baseline].
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "shared.h"
+#include "game.h"
+#include "bot.h"
+#include "beam.h"
+#include "expectimax.h"
+#include "rollout.h"
+
+
+#define DEFAULT_GAMES 16 /**< @brief Default number of games per thread. */
+#define DEFAULT_MAX_PIECES 500 /**< @brief Default max number of blocks per game. */
+#define DEFAULT_LENGTH 10 /**< @brief Default number of blocks of a continuation of the rollout planner. */
+#define MAX_THREADS 256 /**< @brief Max number of threads. */
+#define BENCH_SEED 2017 /**< @brief Seed of the first game. */
+#define TOLERANCE 0.10 /**< @brief Max relative slowdown against the baseline. */
+#define LINE_LENGTH 256 /**< @brief Max length of a line of the baseline. */
+
+/**
+ * @struct Result
+ * @brief Result of a run.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int threads; /**< @brief Number of threads. */
+    long pieces; /**< @brief Number of locked blocks. */
+    long games; /**< @brief Number of played games. */
+    double seconds; /**< @brief Wall-clock time. */
+} Result;
+
+static int games_per_thread = DEFAULT_GAMES; /**< @brief Number of games per thread. */
+static int max_pieces = DEFAULT_MAX_PIECES; /**< @brief Max number of blocks per game. */
+static int depth = 1; /**< @brief Number of blocks searched by the bot. */
+static int width = 0; /**< @brief Number of boards kept by the beam search after each block, 0 to play with the bot. */
+static int branching = 0; /**< @brief Number of placements searched further by the expectimax search, or played out by the rollout planner, 0 for the bot or all of them. */
+static int rollouts = 0; /**< @brief Number of continuations played by the rollout planner from each placement, 0 to play with the bot. */
+static int length = DEFAULT_LENGTH; /**< @brief Number of blocks of a continuation of the rollout planner. */
+static int table_megabytes = 0; /**< @brief Memory budget of the transposition table of the expectimax search in MiB, 0 for the default. */
+static int expand_threads = 1; /**< @brief Number of threads that expand each layer of the beam search, the root of the expectimax search, or the continuations of the rollout planner. */
+static pthread_barrier_t start_barrier; /**< @brief Barrier to start all the threads together. */
+
+/**
+ * @brief Thread routine: play the fixed-seed games.
+ *
+ * @param arg pointer to the number of locked blocks, set at the end.
+ * @return NULL.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void *play_routine(void *arg) {
+    long *pieces = arg;
+    Game *game = create_game();
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    bot->depth = depth;
+    Beam *beam = width > 0 ? create_beam(&DEFAULT_WEIGHTS, width, depth, expand_threads) : NULL;
+    Rollout *rollout = beam == NULL && rollouts > 0 ? create_rollout(&DEFAULT_WEIGHTS, branching, rollouts, length, ROLLOUT_GREEDY, expand_threads) : NULL;
+    Expectimax *expectimax = beam == NULL && rollout == NULL && branching > 0 ? create_expectimax(&DEFAULT_WEIGHTS, depth, branching, expand_threads, (size_t)table_megabytes << 20) : NULL;
+    pthread_barrier_wait(&start_barrier);
+
+    long count = 0;
+    int i, p;
+    for (i = 0; i < games_per_thread; i++) {
+        init_game(game, OPT_GHOST_OFF, BENCH_SEED + i);
+        for (p = 0; p < max_pieces; p++) {
+            count++;
+            int result;
+            if (beam != NULL) {
+                result = play_block_beam(beam, game);
+            }
+            else if (rollout != NULL) {
+                result = play_block_rollout(rollout, game);
+            }
+            else if (expectimax != NULL) {
+                result = play_block_expectimax(expectimax, game);
+            }
+            else {
+                result = play_block_bot(bot, game);
+            }
+            if (result == TICK_GAME_OVER) {
+                break;
+            }
+        }
+    }
+    *pieces = count;
+
+    if (beam != NULL) {
+        delete_beam(beam);
+    }
+    if (expectimax != NULL) {
+        delete_expectimax(expectimax);
+    }
+    if (rollout != NULL) {
+        delete_rollout(rollout);
+    }
+    delete_bot(bot);
+    delete_game(game);
+    return NULL;
+}
+
+/**
+ * @brief Play the games on a given number of threads.
+ *
+ * @param threads number of threads.
+ * @return result of the run.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static Result run(int threads) {
+    pthread_t ids[MAX_THREADS];
+    long pieces[MAX_THREADS];
+    Result r = {threads, 0, (long)threads*games_per_thread, 0};
+
+    pthread_barrier_init(&start_barrier, NULL, threads + 1);
+    int i;
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&ids[i], NULL, play_routine, &pieces[i]) != 0) {
+            ERROR_EXIT("pthread_create");
+        }
+    }
+    pthread_barrier_wait(&start_barrier);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        r.pieces += pieces[i];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_barrier_destroy(&start_barrier);
+
+    r.seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return r;
+}
+
+/**
+ * @brief Compare the results against a baseline written by a previous run.
+ *
+ * @param path baseline path.
+ * @param results results.
+ * @param count number of results.
+ * @return true if no run is slower than the baseline beyond the tolerance, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool compare_baseline(const char *path, Result *results, int count) {
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        ERROR_EXIT("fopen");
+    }
+    bool ok = true;
+    char line[LINE_LENGTH];
+    fprintf(stderr, "threads  pieces/s  baseline  ratio\n");
+    // one result per line
+    while (fgets(line, sizeof(line), in) != NULL) {
+        char *threads = strstr(line, "\"threads\": ");
+        char *pieces = strstr(line, "\"pieces\": ");
+        char *pps = strstr(line, "\"pieces_per_sec\": ");
+        if (threads == NULL || pieces == NULL || pps == NULL) {
+            continue;
+        }
+        int t = atoi(threads + strlen("\"threads\": "));
+        int i;
+        for (i = 0; i < count; i++) {
+            if (results[i].threads != t) {
+                continue;
+            }
+            double base = atof(pps + strlen("\"pieces_per_sec\": "));
+            double curr = results[i].pieces / results[i].seconds;
+            fprintf(stderr, "%7d  %8.0f  %8.0f  %5.2f\n", t, curr, base, curr / base);
+            if (curr < base*(1 - TOLERANCE)) {
+                ok = false;
+            }
+            // the games are deterministic: a different count means that the rules or the bot changed
+            if (atol(pieces + strlen("\"pieces\": ")) != results[i].pieces) {
+                fprintf(stderr, "%7d  different games than the baseline\n", t);
+            }
+        }
+    }
+    fclose(in);
+    return ok;
+}
+
+/**
+ * @brief Benchmark routine.
+ *
+ * @param argc number of arguments.
+ * @param argv arguments.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+int main(int argc, char *argv[]) {
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    FILE *out = stdout;
+    const char *baseline = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:g:p:d:k:e:m:r:l:x:o:b:")) != -1) {
+        if (opt == 't' && atoi(optarg) > 0) {
+            max_threads = atoi(optarg);
+        }
+        else if (opt == 'g' && atoi(optarg) > 0) {
+            games_per_thread = atoi(optarg);
+        }
+        else if (opt == 'p' && atoi(optarg) > 0) {
+            max_pieces = atoi(optarg);
+        }
+        else if (opt == 'd' && atoi(optarg) > 0) {
+            depth = atoi(optarg);
+        }
+        else if (opt == 'k' && atoi(optarg) > 0) {
+            width = atoi(optarg);
+        }
+        else if (opt == 'e' && atoi(optarg) > 0) {
+            branching = atoi(optarg);
+        }
+        else if (opt == 'm' && atoi(optarg) > 0) {
+            table_megabytes = atoi(optarg);
+        }
+        else if (opt == 'r' && atoi(optarg) > 0) {
+            rollouts = atoi(optarg);
+        }
+        else if (opt == 'l' && atoi(optarg) >= 0) {
+            length = atoi(optarg);
+        }
+        else if (opt == 'x' && atoi(optarg) > 0) {
+            expand_threads = atoi(optarg);
+        }
+        else if (opt == 'o') {
+            out = fopen(optarg, "w");
+            if (out == NULL) {
+                ERROR_EXIT("fopen");
+            }
+        }
+        else if (opt == 'b') {
+            baseline = optarg;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-t max_threads] [-g games_per_thread] [-p max_pieces] [-d depth] [-k width | -e branching [-m megabytes] | -r rollouts [-l length]] [-x threads] [-o file] [-b baseline]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (max_threads > MAX_THREADS) {
+        max_threads = MAX_THREADS;
+    }
+
+    Result results[MAX_THREADS];
+    fprintf(out, "{\n  \"benchmark\": \"bench_games\",\n  \"games_per_thread\": %d,\n  \"max_pieces\": %d,\n  \"depth\": %d,\n  \"width\": %d,\n  \"branching\": %d,\n  \"rollouts\": %d,\n  \"length\": %d,\n  \"expand_threads\": %d,\n  \"results\": [",
+            games_per_thread, max_pieces, depth, width, branching, rollouts, length, expand_threads);
+    int t;
+    for (t = 1; t <= max_threads; t++) {
+        results[t - 1] = run(t);
+        Result *r = &results[t - 1];
+        double pps = r->pieces / r->seconds;
+        // every thread does the same work: ideal scaling multiplies the throughput of one thread
+        double efficiency = pps / (t*(results[0].pieces / results[0].seconds));
+        fprintf(out, "%s\n    {\"threads\": %d, \"pieces\": %ld, \"games\": %ld, \"seconds\": %.3f, "
+                "\"pieces_per_sec\": %.0f, \"games_per_sec\": %.2f, \"efficiency\": %.3f}",
+                t == 1 ? "" : ",", t, r->pieces, r->games, r->seconds, pps, r->games / r->seconds, efficiency);
+        fflush(out);
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    if (baseline != NULL && !compare_baseline(baseline, results, max_threads)) {
+        fprintf(stderr, "Slower than the baseline by more than %.0f%%\n", TOLERANCE*100);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
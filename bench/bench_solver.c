@@ -0,0 +1,191 @@
+/**
+ * @file bench_solver.c
+ * @brief Benchmark of the perfect-clear solver on fixed-seed puzzles, from 1 to N threads.
+ *
+ * Each puzzle is a board whose bottom rows have random holes, about a third of the cells, and a random
+ * sequence of blocks to empty it with. Most of these puzzles have no solution, and proving it takes up
+ * to millions of boards: they measure the whole search stack (placements, pruning, visited set). For
+ * each number of threads, a new solver solves every puzzle, and the time, the boards searched and the
+ * puzzles solved are reported as JSON.
+ *
+ * Usage: bench_solver [-t max_threads] [-p puzzles] [-r rows] [-n blocks] [-m megabytes] [-o file].
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shared.h"
+#include "state.h"
+#include "solver.h"
+
+
+#define DEFAULT_PUZZLES 10 /**< @brief Default number of puzzles. */
+#define DEFAULT_ROWS 2 /**< @brief Default number of rows with holes. */
+#define DEFAULT_BLOCKS 8 /**< @brief Default number of blocks of a puzzle. */
+#define BENCH_SEED 2017 /**< @brief Seed of the puzzles. */
+
+/**
+ * @struct Puzzle
+ * @brief Board and blocks of a puzzle.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    GameState state; /**< @brief State with the board. */
+    uint8_t types[SOLVER_MAX_PIECES]; /**< @brief Types of the blocks. */
+} Puzzle;
+
+/**
+ * @struct Result
+ * @brief Result of a run.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int threads; /**< @brief Number of threads. */
+    long nodes; /**< @brief Number of boards searched. */
+    int solved; /**< @brief Number of puzzles with a solution. */
+    double seconds; /**< @brief Wall-clock time. */
+} Result;
+
+static int puzzle_count = DEFAULT_PUZZLES; /**< @brief Number of puzzles. */
+static int rows = DEFAULT_ROWS; /**< @brief Number of rows with holes. */
+static int blocks = DEFAULT_BLOCKS; /**< @brief Number of blocks of a puzzle. */
+static int table_megabytes = 0; /**< @brief Memory budget of the visited set in MiB, 0 for the default. */
+
+/**
+ * @brief Generate the fixed-seed puzzles.
+ *
+ * @param puzzles puzzles, puzzle_count of them, written.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void generate_puzzles(Puzzle *puzzles) {
+    unsigned int seed = BENCH_SEED;
+    int i, k, row, col;
+    for (i = 0; i < puzzle_count; i++) {
+        init_state(&puzzles[i].state, OPT_GHOST_OFF, BENCH_SEED + i);
+        for (k = 0; k < blocks; k++) {
+            puzzles[i].types[k] = F + rand_r(&seed) % I_SHORT;
+        }
+        for (row = ROWS - rows; row < ROWS; row++) {
+            for (col = 0; col < COLUMNS; col++) {
+                if (rand_r(&seed) % 3 != 0) {
+                    puzzles[i].state.board[row] |= 1 << col;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Solve the puzzles on a given number of threads.
+ *
+ * @param puzzles puzzles.
+ * @param threads number of threads.
+ * @return result of the run.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static Result run(Puzzle *puzzles, int threads) {
+    Result r = {threads, 0, 0, 0};
+    Solver *sv = create_solver(threads, (size_t)table_megabytes << 20);
+    Placement solution[SOLVER_MAX_PIECES];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int i;
+    for (i = 0; i < puzzle_count; i++) {
+        if (solve_solver(sv, &puzzles[i].state, puzzles[i].types, blocks, solution) >= 0) {
+            r.solved++;
+        }
+        r.nodes += get_nodes_solver(sv);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    delete_solver(sv);
+    r.seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return r;
+}
+
+/**
+ * @brief Benchmark routine.
+ *
+ * @param argc number of arguments.
+ * @param argv arguments.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+int main(int argc, char *argv[]) {
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    FILE *out = stdout;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:p:r:n:m:o:")) != -1) {
+        if (opt == 't' && atoi(optarg) > 0) {
+            max_threads = atoi(optarg);
+        }
+        else if (opt == 'p' && atoi(optarg) > 0) {
+            puzzle_count = atoi(optarg);
+        }
+        else if (opt == 'r' && atoi(optarg) > 0 && atoi(optarg) < ROWS - BLOCK_MAX_SIZE) {
+            rows = atoi(optarg);
+        }
+        else if (opt == 'n' && atoi(optarg) > 0 && atoi(optarg) <= SOLVER_MAX_PIECES) {
+            blocks = atoi(optarg);
+        }
+        else if (opt == 'm' && atoi(optarg) > 0) {
+            table_megabytes = atoi(optarg);
+        }
+        else if (opt == 'o') {
+            out = fopen(optarg, "w");
+            if (out == NULL) {
+                ERROR_EXIT("fopen");
+            }
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-t max_threads] [-p puzzles] [-r rows] [-n blocks] [-m megabytes] [-o file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (max_threads > POOL_MAX_THREADS) {
+        max_threads = POOL_MAX_THREADS;
+    }
+
+    Puzzle *puzzles = malloc(puzzle_count*sizeof(Puzzle));
+    if (puzzles == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    generate_puzzles(puzzles);
+    fprintf(out, "{\n  \"benchmark\": \"bench_solver\",\n  \"puzzles\": %d,\n  \"rows\": %d,\n  \"blocks\": %d,\n  \"results\": [",
+            puzzle_count, rows, blocks);
+    int t;
+    for (t = 1; t <= max_threads; t++) {
+        Result r = run(puzzles, t);
+        fprintf(out, "%s\n    {\"threads\": %d, \"solved\": %d, \"nodes\": %ld, \"seconds\": %.3f, \"nodes_per_sec\": %.0f}",
+                t == 1 ? "" : ",", t, r.solved, r.nodes, r.seconds, r.nodes / r.seconds);
+        fflush(out);
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(puzzles);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,622 @@
+/**
+ * @file bench_tui.c
+ * @brief End-to-end input latency of the real game: from a key written to the terminal to the board update on it.
+ *
+ * TetrisC is run under a pseudo-terminal, with no display. Keys are injected as a terminal would send
+ * them, and the output is parsed as a terminal would draw it, tracking the cursor, until a cell of the
+ * main game area is written. The latency percentiles of each action are printed as JSON, in microseconds.
+ * Actions that do not change the board (e.g. the rotation of the O block) are counted as missed.
+ *
+ * Usage: bench_tui [-e executable] [-r ncurses|ansi] [-n rounds] [-o file].
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+
+#include "shared.h"
+#include "layout.h"
+
+
+#define DEFAULT_ROUNDS 20 /**< @brief Default number of times each action is measured. */
+#define MAX_ROUNDS 1000 /**< @brief Max number of rounds. */
+#define ROUNDS_PER_GAME 4 /**< @brief Number of rounds before the game is restarted, so that the stack never tops out. */
+#define WARMUP_ROUNDS 1 /**< @brief Number of rounds played before the measured ones. */
+#define TERM_LINES 40 /**< @brief Number of lines of the pseudo-terminal. */
+#define TERM_COLS 100 /**< @brief Number of columns of the pseudo-terminal. */
+#define TIMEOUT_MILLIS 500 /**< @brief Max waiting time for the board update of an action. */
+#define LOCK_MILLIS 1000 /**< @brief Max waiting time for the lock of a dropped block: longer than a tick of the first level. */
+#define QUIET_MILLIS 30 /**< @brief Silence after which the frame of an action is over. */
+#define STARTUP_MILLIS 300 /**< @brief Silence after which the game is ready. */
+#define MIN_PAUSE_MILLIS 30 /**< @brief Min pause between two actions. */
+#define MAX_PAUSE_MILLIS 130 /**< @brief Max pause between two actions. */
+#define BENCH_SEED 2017 /**< @brief Seed of the pauses. */
+#define MAX_PARAMS 16 /**< @brief Max number of parameters of a control sequence. */
+#define BUFFER_SIZE 65536 /**< @brief Size of the read buffer. */
+
+/**
+ * @struct Action
+ * @brief Measured action.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    const char *name; /**< @brief Name. */
+    const char *keys; /**< @brief Bytes sent by the terminal. */
+} Action;
+
+/**
+ * @brief Actions of a round, in order: the block is moved back and forth, the menu is opened and closed, then the block is dropped.
+ */
+static const Action ACTIONS[] = {
+    {"left", "\033OD"},
+    {"right", "\033OC"},
+    {"rotate", "\033OA"},
+    {"down", "\033OB"},
+    {"menu", "p"},
+    {"resume", "\n"},
+    {"drop", " "}
+};
+
+#define ACTIONS_COUNT (int)(sizeof(ACTIONS) / sizeof(ACTIONS[0])) /**< @brief Number of actions. */
+
+/**
+ * @enum parser_state
+ * @brief States of the terminal output parser.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum parser_state {
+    STATE_TEXT, /**< @brief Printable characters and control characters. */
+    STATE_ESCAPE, /**< @brief After ESC. */
+    STATE_CSI, /**< @brief Inside a control sequence (ESC [). */
+    STATE_CHARSET, /**< @brief Character set designation (ESC ( and similar): one more byte. */
+    STATE_OSC /**< @brief Operating system command (ESC ]), until BEL or ST. */
+};
+
+/**
+ * @struct Parser
+ * @brief Cursor of the emulated terminal and parser state.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int state; /**< @brief State (enum parser_state). */
+    int y; /**< @brief Cursor row. */
+    int x; /**< @brief Cursor column, TERM_COLS if the next character wraps. */
+    int saved_y; /**< @brief Row saved by ESC 7. */
+    int saved_x; /**< @brief Column saved by ESC 7. */
+    int params[MAX_PARAMS]; /**< @brief Parameters of the current control sequence, -1 if omitted. */
+    int count; /**< @brief Number of parameters. */
+} Parser;
+
+static int board_top; /**< @brief First row of the cells of the main game area. */
+static int board_bottom; /**< @brief Last row of the cells of the main game area. */
+static int board_left; /**< @brief First column of the cells of the main game area. */
+static int board_right; /**< @brief Last column of the cells of the main game area. */
+
+/**
+ * @brief Return nanoseconds of the monotonic clock.
+ *
+ * @return time in nanoseconds.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long now_nanos() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec*1000000000L + now.tv_nsec;
+}
+
+/**
+ * @brief Return true if a horizontal run of cells intersects the main game area.
+ *
+ * @param y row.
+ * @param x0 first column.
+ * @param x1 last column.
+ * @return true if some cell is inside the main game area, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool touches_board(int y, int x0, int x1) {
+    return y >= board_top && y <= board_bottom && x1 >= board_left && x0 <= board_right;
+}
+
+/**
+ * @brief Return a parameter of the current control sequence.
+ *
+ * @param p parser pointer.
+ * @param i parameter index.
+ * @param def default value, if the parameter is omitted or zero.
+ * @return parameter value.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int get_param(Parser *p, int i, int def) {
+    return (i < p->count && p->params[i] > 0) ? p->params[i] : def;
+}
+
+/**
+ * @brief Clamp the cursor to the screen.
+ *
+ * @param p parser pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void clamp_cursor(Parser *p) {
+    p->y = (p->y < 0) ? 0 : (p->y >= TERM_LINES) ? TERM_LINES - 1 : p->y;
+    p->x = (p->x < 0) ? 0 : (p->x > TERM_COLS) ? TERM_COLS : p->x;
+}
+
+/**
+ * @brief Execute a control sequence.
+ *
+ * @param p parser pointer.
+ * @param final final byte.
+ * @return true if the sequence changed a cell of the main game area, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool execute_csi(Parser *p, char final) {
+    int n = get_param(p, 0, 1);
+    int x = (p->x >= TERM_COLS) ? TERM_COLS - 1 : p->x;
+    bool touched = false;
+    switch (final) {
+        case 'H':
+        case 'f':
+            p->y = get_param(p, 0, 1) - 1;
+            p->x = get_param(p, 1, 1) - 1;
+            break;
+        case 'A':
+            p->y -= n;
+            break;
+        case 'B':
+            p->y += n;
+            break;
+        case 'C':
+            p->x = x + n;
+            break;
+        case 'D':
+            p->x = x - n;
+            break;
+        case 'G':
+        case '`':
+            p->x = n - 1;
+            break;
+        case 'd':
+            p->y = n - 1;
+            break;
+        case 'b':
+            // repetition of the last character
+            touched = touches_board(p->y, x, x + n - 1);
+            p->x = x + n;
+            break;
+        case 'X':
+        case '@':
+        case 'P':
+            touched = touches_board(p->y, x, x + n - 1);
+            break;
+        case 'K':
+            // erase to the end of the line, to the cursor, or the whole line
+            if (get_param(p, 0, 0) == 0) {
+                touched = touches_board(p->y, x, TERM_COLS - 1);
+            }
+            else {
+                touched = touches_board(p->y, 0, get_param(p, 0, 0) == 1 ? x : TERM_COLS - 1);
+            }
+            break;
+        case 'J':
+        case 'L':
+        case 'M':
+            touched = true;
+            break;
+        case 'r':
+            // a new scrolling region homes the cursor
+            p->y = 0;
+            p->x = 0;
+            break;
+    }
+    clamp_cursor(p);
+    return touched;
+}
+
+/**
+ * @brief Parse terminal output, tracking the cursor.
+ *
+ * @param p parser pointer.
+ * @param buf bytes.
+ * @param len number of bytes.
+ * @return true if some cell of the main game area was written, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool parse_output(Parser *p, const char *buf, ssize_t len) {
+    bool touched = false;
+    ssize_t i;
+    for (i = 0; i < len; i++) {
+        unsigned char c = buf[i];
+        switch (p->state) {
+            case STATE_TEXT:
+                if (c == '\033') {
+                    p->state = STATE_ESCAPE;
+                }
+                else if (c == '\r') {
+                    p->x = 0;
+                }
+                else if (c == '\n') {
+                    p->y++;
+                }
+                else if (c == '\b') {
+                    p->x--;
+                }
+                else if (c == '\t') {
+                    p->x = (p->x / 8 + 1)*8;
+                }
+                else if (c >= ' ' && c != 0x7F && (c & 0xC0) != 0x80) {
+                    // printable character, or first byte of a UTF-8 character: autowrap is deferred
+                    if (p->x >= TERM_COLS) {
+                        p->x = 0;
+                        p->y++;
+                    }
+                    clamp_cursor(p);
+                    touched |= touches_board(p->y, p->x, p->x);
+                    p->x++;
+                }
+                clamp_cursor(p);
+                break;
+            case STATE_ESCAPE:
+                p->state = STATE_TEXT;
+                if (c == '[') {
+                    p->state = STATE_CSI;
+                    p->count = 0;
+                    p->params[0] = -1;
+                }
+                else if (c == '(' || c == ')' || c == '*' || c == '+' || c == '#') {
+                    p->state = STATE_CHARSET;
+                }
+                else if (c == ']') {
+                    p->state = STATE_OSC;
+                }
+                else if (c == '7') {
+                    p->saved_y = p->y;
+                    p->saved_x = p->x;
+                }
+                else if (c == '8') {
+                    p->y = p->saved_y;
+                    p->x = p->saved_x;
+                }
+                else if (c == 'M') {
+                    // reverse index
+                    p->y--;
+                    clamp_cursor(p);
+                }
+                break;
+            case STATE_CSI:
+                if (c >= '0' && c <= '9') {
+                    int *param = &p->params[p->count];
+                    *param = (*param < 0 ? 0 : *param*10) + (c - '0');
+                }
+                else if (c == ';') {
+                    if (p->count < MAX_PARAMS - 1) {
+                        p->count++;
+                    }
+                    p->params[p->count] = -1;
+                }
+                else if (c >= 0x40 && c <= 0x7E) {
+                    p->count++;
+                    p->state = STATE_TEXT;
+                    touched |= execute_csi(p, c);
+                }
+                // private markers ('?', '>') and intermediate bytes are ignored
+                break;
+            case STATE_CHARSET:
+                p->state = STATE_TEXT;
+                break;
+            case STATE_OSC:
+                if (c == '\a' || c == '\\') {
+                    p->state = STATE_TEXT;
+                }
+                break;
+        }
+    }
+    return touched;
+}
+
+/**
+ * @brief Read the output of the game until a given time, parsing it.
+ *
+ * @param fd pseudo-terminal master.
+ * @param p parser pointer.
+ * @param deadline max time in nanoseconds.
+ * @param quiet_millis silence after which it returns, -1 to wait until the deadline.
+ * @param stop_on_board true to return at the first write to the main game area.
+ * @return time of the read that wrote the main game area, -1 if none, 0 at the end of the output.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long read_output(int fd, Parser *p, long deadline, int quiet_millis, bool stop_on_board) {
+    static char buf[BUFFER_SIZE];
+    long board_time = -1;
+    while (true) {
+        long left = (deadline - now_nanos()) / 1000000;
+        if (left <= 0) {
+            return board_time;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int timeout = (quiet_millis >= 0 && quiet_millis < left) ? quiet_millis : left;
+        int ready = poll(&pfd, 1, timeout);
+        if (ready == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            // timeout: silence or deadline
+            if (quiet_millis >= 0) {
+                return board_time;
+            }
+            continue;
+        }
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            // the game has exited
+            return 0;
+        }
+        long read_time = now_nanos();
+        if (parse_output(p, buf, n) && board_time == -1) {
+            board_time = read_time;
+            if (stop_on_board) {
+                return board_time;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Send keys to the game.
+ *
+ * @param fd pseudo-terminal master.
+ * @param keys bytes.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void send_keys(int fd, const char *keys) {
+    size_t len = strlen(keys);
+    while (len > 0) {
+        ssize_t n = write(fd, keys, len);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ERROR_EXIT("write");
+        }
+        keys += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief Send keys that are not measured, and consume the output they cause.
+ *
+ * @param fd pseudo-terminal master.
+ * @param p parser pointer.
+ * @param keys bytes.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void send_unmeasured(int fd, Parser *p, const char *keys) {
+    send_keys(fd, keys);
+    read_output(fd, p, now_nanos() + TIMEOUT_MILLIS*1000000L, QUIET_MILLIS*2, false);
+}
+
+/**
+ * @brief Compare two latencies, for qsort().
+ *
+ * @param a first latency.
+ * @param b second latency.
+ * @return negative, zero or positive.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int compare_longs(const void *a, const void *b) {
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Return a percentile of sorted latencies (nearest rank).
+ *
+ * @param sorted sorted latencies.
+ * @param count number of latencies, at least 1.
+ * @param percentile percentile, between 0 and 100.
+ * @return latency.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long get_percentile(long *sorted, int count, double percentile) {
+    int rank = (int)(percentile / 100*count + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[(rank > count ? count : rank) - 1];
+}
+
+/**
+ * @brief Benchmark routine.
+ *
+ * @param argc number of arguments.
+ * @param argv arguments.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+int main(int argc, char *argv[]) {
+    // by default, the game built next to the benchmark
+    char exe[4096];
+    const char *slash = strrchr(argv[0], '/');
+    snprintf(exe, sizeof(exe), "%.*sTetrisC", slash == NULL ? 0 : (int)(slash - argv[0] + 1), argv[0]);
+    const char *backend = "ncurses";
+    int rounds = DEFAULT_ROUNDS;
+    FILE *out = stdout;
+    int opt;
+    while ((opt = getopt(argc, argv, "e:r:n:o:")) != -1) {
+        if (opt == 'e') {
+            snprintf(exe, sizeof(exe), "%s", optarg);
+        }
+        else if (opt == 'r' && (strcmp(optarg, "ncurses") == 0 || strcmp(optarg, "ansi") == 0)) {
+            backend = optarg;
+        }
+        else if (opt == 'n' && atoi(optarg) > 0) {
+            rounds = atoi(optarg) < MAX_ROUNDS ? atoi(optarg) : MAX_ROUNDS;
+        }
+        else if (opt == 'o') {
+            out = fopen(optarg, "w");
+            if (out == NULL) {
+                ERROR_EXIT("fopen");
+            }
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-e executable] [-r ncurses|ansi] [-n rounds] [-o file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // same layout as the game
+    int curr_x = (TERM_COLS - CURR_WIDTH) / 2;
+    int curr_y = (TERM_LINES - CURR_HEIGHT - HELP_HEIGHT) / 2;
+    board_top = curr_y + 1;
+    board_bottom = curr_y + CURR_HEIGHT - 2;
+    board_left = curr_x + 1;
+    board_right = curr_x + CURR_WIDTH - 2;
+
+    int fd;
+    struct winsize ws = {TERM_LINES, TERM_COLS, 0, 0};
+    pid_t pid = forkpty(&fd, NULL, NULL, &ws);
+    if (pid == -1) {
+        ERROR_EXIT("forkpty");
+    }
+    if (pid == 0) {
+        setenv("TERM", "xterm", 1);
+        execl(exe, exe, "-r", backend, (char *)NULL);
+        perror(exe);
+        _exit(EXIT_FAILURE);
+    }
+
+    Parser parser;
+    memset(&parser, 0, sizeof(parser));
+    // main menu, then new game
+    if (read_output(fd, &parser, now_nanos() + 5000000000L, STARTUP_MILLIS, false) == 0) {
+        fprintf(stderr, "%s exited\n", exe);
+        return EXIT_FAILURE;
+    }
+    send_unmeasured(fd, &parser, "\n");
+
+    static long latencies[ACTIONS_COUNT][MAX_ROUNDS];
+    int counts[ACTIONS_COUNT] = {0};
+    int missed[ACTIONS_COUNT] = {0};
+    unsigned int seed = BENCH_SEED;
+    int r, a;
+    // the first keys of the game are slower: page faults, lazy initialization of the terminal
+    for (r = -WARMUP_ROUNDS; r < rounds; r++) {
+        if (r > 0 && r % ROUNDS_PER_GAME == 0) {
+            // restart from the game menu
+            send_unmeasured(fd, &parser, "p");
+            send_unmeasured(fd, &parser, "\033OB");
+            send_unmeasured(fd, &parser, "\n");
+        }
+        for (a = 0; a < ACTIONS_COUNT; a++) {
+            // random pause, so that the keys are not in phase with the gravity timer
+            read_output(fd, &parser, now_nanos() + (MIN_PAUSE_MILLIS + rand_r(&seed) % (MAX_PAUSE_MILLIS - MIN_PAUSE_MILLIS))*1000000L, -1, false);
+            long start = now_nanos();
+            send_keys(fd, ACTIONS[a].keys);
+            long board_time = read_output(fd, &parser, start + TIMEOUT_MILLIS*1000000L, -1, true);
+            if (board_time == 0) {
+                fprintf(stderr, "%s exited\n", exe);
+                return EXIT_FAILURE;
+            }
+            if (r >= 0 && board_time > 0) {
+                latencies[a][counts[a]++] = board_time - start;
+            }
+            else if (r >= 0) {
+                missed[a]++;
+            }
+            // rest of the frame
+            read_output(fd, &parser, now_nanos() + TIMEOUT_MILLIS*1000000L, QUIET_MILLIS, false);
+        }
+        // the dropped block locks at the next tick: until then, the moves of the next round would act on it
+        read_output(fd, &parser, now_nanos() + LOCK_MILLIS*1000000L, -1, true);
+        read_output(fd, &parser, now_nanos() + TIMEOUT_MILLIS*1000000L, QUIET_MILLIS, false);
+    }
+
+    // back to the main menu, then exit
+    send_unmeasured(fd, &parser, "p");
+    send_unmeasured(fd, &parser, "\033OB");
+    send_unmeasured(fd, &parser, "\033OB");
+    send_unmeasured(fd, &parser, "\n");
+    send_unmeasured(fd, &parser, "\033OA");
+    send_keys(fd, "\n");
+    read_output(fd, &parser, now_nanos() + 1000000000L, -1, false);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    close(fd);
+
+    fprintf(out, "{\n  \"benchmark\": \"bench_tui\",\n  \"backend\": \"%s\",\n  \"rounds\": %d,\n  \"results\": [", backend, rounds);
+    for (a = 0; a < ACTIONS_COUNT; a++) {
+        fprintf(out, "%s\n    {\"action\": \"%s\", \"count\": %d, \"missed\": %d", a == 0 ? "" : ",", ACTIONS[a].name, counts[a], missed[a]);
+        if (counts[a] > 0) {
+            qsort(latencies[a], counts[a], sizeof(long), compare_longs);
+            fprintf(out, ", \"p50_us\": %.1f, \"p90_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f",
+                    get_percentile(latencies[a], counts[a], 50) / 1e3, get_percentile(latencies[a], counts[a], 90) / 1e3,
+                    get_percentile(latencies[a], counts[a], 99) / 1e3, latencies[a][counts[a] - 1] / 1e3);
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    return EXIT_SUCCESS;
+}
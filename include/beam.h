@@ -0,0 +1,67 @@
+/**
+ * @file beam.h
+ * @brief Functions of a beam-search planner, which places the falling block looking ahead in the queue.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef BEAM_H
+#define BEAM_H
+
+/**
+ * @brief Create a planner, with the buffers of its layers and its threads.
+ *
+ * @param w weights of the board features.
+ * @param width number of boards kept after each block, at most BEAM_MAX_WIDTH.
+ * @param depth number of blocks placed, at most BEAM_MAX_DEPTH: 1 for the falling one, 2 for the next one too, and so on.
+ * @param threads number of threads that expand each layer, the calling one included, at most POOL_MAX_THREADS.
+ * @return planner pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Beam *create_beam(const Weights *w, int width, int depth, int threads);
+
+/**
+ * @brief Stop the threads of a planner and free it.
+ *
+ * @param b planner pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_beam(Beam *b);
+
+/**
+ * @brief Find the placement of the falling block that leads to the best board after the last searched block.
+ *
+ * @param b planner pointer.
+ * @param g game pointer.
+ * @return best placement.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Placement find_placement_beam(Beam *b, Game *g);
+
+/**
+ * @brief Play the current block: move it to the best placement and lock it, as play_block_bot().
+ *
+ * @param b planner pointer.
+ * @param g game pointer.
+ * @return outcome of the lock (enum tick_result).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int play_block_beam(Beam *b, Game *g);
+
+#endif
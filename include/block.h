@@ -179,4 +179,30 @@ extern bool can_move_block(Block *b, Field *f, int dir);
  */
 extern bool can_rotate_block(Block *b, Field *f);
 
+/**
+ * @brief Return the cells of a block, relative to its rotation center.
+ *
+ * @param b block pointer.
+ * @param cells row and column offsets of the cells, at least BLOCK_MAX_SIZE.
+ * @return number of cells.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int get_cells_block(Block *b, int cells[][2]);
+
+/**
+ * @brief Return the cells that must be free to rotate a block, relative to its rotation center.
+ *
+ * @param b block pointer.
+ * @param cells row and column offsets of the cells, at least ROTATION_MAX_CELLS.
+ * @return number of cells.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int get_rotation_cells_block(Block *b, int cells[][2]);
+
 #endif
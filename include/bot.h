@@ -0,0 +1,142 @@
+/**
+ * @file bot.h
+ * @brief Functions of a bot that chooses the placement of each block.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef BOT_H
+#define BOT_H
+
+extern const Weights DEFAULT_WEIGHTS; /**< @brief Default weights of the board features. */
+
+/**
+ * @brief Allocate new bot, that searches the falling block only: set depth to 2 to also search the next one.
+ *
+ * @param w weights of the board features.
+ * @return bot pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Bot *create_bot(const Weights *w);
+
+/**
+ * @brief Deallocate bot.
+ *
+ * @param b bot pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_bot(Bot *b);
+
+/**
+ * @brief Evaluate a board with the height, lines, holes and bumpiness weights: the higher, the better.
+ *
+ * @param f field pointer, without the falling block.
+ * @param lines number of rows deleted by the last placement.
+ * @param w weights of the board features.
+ * @return weighted sum of the board features.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern double evaluate_field_bot(Field *f, int lines, const Weights *w);
+
+/**
+ * @brief Evaluate a board of a batch, from its features.
+ *
+ * @param f features of the batch, written by extract_features().
+ * @param i board index.
+ * @param lines number of rows deleted by the placements that led to the board.
+ * @param w weights of the board features.
+ * @return weighted sum of the board features.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern double evaluate_batch_bot(FeatureBatch *f, int i, int lines, const Weights *w);
+
+/**
+ * @brief Evaluate the board of a state with all the weighted features, including the transitions and the wells.
+ *
+ * @param s state pointer.
+ * @param lines number of rows deleted by the last placement.
+ * @param w weights of the board features.
+ * @return weighted sum of the board features.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern double evaluate_state_bot(GameState *s, int lines, const Weights *w);
+
+/**
+ * @brief Find the placement of the current block with the best board after the lock of the searched blocks.
+ *
+ * @param b bot pointer.
+ * @param g game pointer.
+ * @return best placement.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Placement find_placement_bot(Bot *b, Game *g);
+
+/**
+ * @brief Find the best placement of the current block within a time budget, deepening the search one block at a time.
+ *
+ * The search of the falling block alone always completes; the deeper ones, up to the depth of the bot,
+ * are used only if they end within the budget, which counts from the call: the whole search takes at
+ * most the budget, unless the search of the falling block alone takes longer.
+ *
+ * @param b bot pointer.
+ * @param g game pointer.
+ * @param budget_nanos time budget in nanoseconds.
+ * @return best placement of the deepest complete search.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Placement find_placement_timed_bot(Bot *b, Game *g, long budget_nanos);
+
+/**
+ * @brief Play the current block: move it to the best placement and lock it.
+ *
+ * @param b bot pointer.
+ * @param g game pointer.
+ * @return outcome of the lock (enum tick_result).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int play_block_bot(Bot *b, Game *g);
+
+/**
+ * @brief Play the falling block of a state, without a game: apply the best placement and lock it.
+ *
+ * Headless and allocation-free, for the simulations that only need the board.
+ *
+ * @param b bot pointer.
+ * @param s state pointer.
+ * @return outcome of the lock (enum tick_result).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int play_block_state_bot(Bot *b, GameState *s);
+
+#endif
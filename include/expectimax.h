@@ -0,0 +1,68 @@
+/**
+ * @file expectimax.h
+ * @brief Functions of an expectimax planner, which averages over the blocks that are not shown yet.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef EXPECTIMAX_H
+#define EXPECTIMAX_H
+
+/**
+ * @brief Create a planner, with its transposition table and its threads.
+ *
+ * @param w weights of the board features.
+ * @param depth number of blocks placed, at most EXPECTIMAX_MAX_DEPTH: the falling one, the next one, then unknown ones.
+ * @param branching number of best placements searched further at each block but the last one.
+ * @param threads number of threads that search the placements of the falling block, the calling one included.
+ * @param table_bytes memory budget of the transposition table shared by the threads, 0 for TABLE_DEFAULT_BYTES.
+ * @return planner pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Expectimax *create_expectimax(const Weights *w, int depth, int branching, int threads, size_t table_bytes);
+
+/**
+ * @brief Stop the threads of a planner and free it.
+ *
+ * @param e planner pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_expectimax(Expectimax *e);
+
+/**
+ * @brief Find the placement of the falling block with the best expected board after the last searched block.
+ *
+ * @param e planner pointer.
+ * @param g game pointer.
+ * @return best placement.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Placement find_placement_expectimax(Expectimax *e, Game *g);
+
+/**
+ * @brief Play the current block: move it to the best placement and lock it, as play_block_bot().
+ *
+ * @param e planner pointer.
+ * @param g game pointer.
+ * @return outcome of the lock (enum tick_result).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int play_block_expectimax(Expectimax *e, Game *g);
+
+#endif
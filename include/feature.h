@@ -0,0 +1,51 @@
+/**
+ * @file feature.h
+ * @brief Functions to extract the features of many boards at once, with SIMD kernels.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef FEATURE_H
+#define FEATURE_H
+
+/**
+ * @brief Extract the features of a batch of boards, with the fastest kernel supported by the CPU.
+ *
+ * @param b batch pointer.
+ * @param count number of boards, at most BATCH_SIZE.
+ * @param f features pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void extract_features(BoardBatch *b, int count, FeatureBatch *f);
+
+/**
+ * @brief Return the kernel used by extract_features().
+ *
+ * @return kernel (enum features_kernel).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int get_kernel_feature();
+
+/**
+ * @brief Select the kernel used by extract_features(), to compare them.
+ *
+ * @param kernel kernel (enum features_kernel).
+ * @return true if the CPU supports it, false otherwise and the kernel is unchanged.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern bool set_kernel_feature(int kernel);
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file finesse.h
+ * @brief Functions of a planner of the shortest key sequences that bring the falling block to its final positions.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef FINESSE_H
+#define FINESSE_H
+
+/**
+ * @brief Create a planner, with an empty memo of the searched surfaces.
+ *
+ * @return planner pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Finesse *create_finesse();
+
+/**
+ * @brief Free a planner.
+ *
+ * @param f planner pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_finesse(Finesse *f);
+
+/**
+ * @brief Find the shortest key sequence that brings the falling block to a final position.
+ *
+ * The keys are pressed faster than the fall, as a bot does: no tick moves the block meanwhile. The
+ * sequence ends with FINESSE_DROP, and pressing its keys in the game loop (or with press_key_finesse())
+ * leaves the block at the final position, where the next tick locks it.
+ *
+ * @param f planner pointer.
+ * @param s state pointer: its board and its falling block, as spawned.
+ * @param rot rotation of the final position.
+ * @param row rotation center row of the final position.
+ * @param col rotation center column of the final position.
+ * @param keys keys (enum finesse_key), at least FINESSE_MAX_KEYS.
+ * @return number of keys, or -1 if the final position cannot be reached.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int find_keys_finesse(Finesse *f, const GameState *s, int rot, int row, int col, uint8_t keys[]);
+
+/**
+ * @brief Find the shortest key sequence that places the falling block as a placement does.
+ *
+ * @param f planner pointer.
+ * @param s state pointer: its board and its falling block, as spawned.
+ * @param p placement, as given to place_block_state().
+ * @param keys keys (enum finesse_key), at least FINESSE_MAX_KEYS.
+ * @return number of keys, or -1 if the placement is not valid.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int find_placement_keys_finesse(Finesse *f, const GameState *s, Placement p, uint8_t keys[]);
+
+/**
+ * @brief Count the keys pressed beyond the shortest sequence that brings the falling block to a final position.
+ *
+ * @param f planner pointer.
+ * @param s state pointer: its board and its falling block, as spawned.
+ * @param rot rotation of the final position.
+ * @param row rotation center row of the final position.
+ * @param col rotation center column of the final position.
+ * @param pressed number of keys pressed from the spawn to the final position.
+ * @return number of wasted keys, or -1 if no key sequence reaches the final position.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int count_wasted_keys_finesse(Finesse *f, const GameState *s, int rot, int row, int col, int pressed);
+
+/**
+ * @brief Press a key on a state, as the game loop does on a game.
+ *
+ * @param s state pointer.
+ * @param key key (enum finesse_key).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void press_key_finesse(GameState *s, int key);
+
+/**
+ * @brief Return the number of calls of find_keys_finesse() answered by the memo, and the number of calls.
+ *
+ * @param f planner pointer.
+ * @param hits calls answered by the memo, written.
+ * @param lookups calls, written.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void get_stats_finesse(Finesse *f, long *hits, long *lookups);
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file game.h
+ * @brief Functions to run a game: gravity, moves, row deletion and score.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef GAME_H
+#define GAME_H
+
+/**
+ * @brief Allocate new game, with its game areas and its blocks in a single allocation.
+ *
+ * The game does not allocate while it runs: reuse it for the next games with init_game().
+ *
+ * @return game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Game *create_game();
+
+/**
+ * @brief Deallocate game.
+ *
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_game(Game *g);
+
+/**
+ * @brief Init game: reset statistics and game areas, and drop the first block.
+ *
+ * @param g game pointer.
+ * @param ghost value of 'Ghost' option (enum ghost_option).
+ * @param seed seed of the random number generator of the blocks.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void init_game(Game *g, int ghost, unsigned int seed);
+
+/**
+ * @brief Apply a tick of gravity: move the current block down, or lock it, delete the completed rows and drop the next block.
+ *
+ * @param g game pointer.
+ * @return outcome of the tick (enum tick_result).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int tick_game(Game *g);
+
+/**
+ * @brief Move the current block, if possible.
+ *
+ * @param g game pointer.
+ * @param dir direction.
+ * @return true if the block moved, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern bool move_block_game(Game *g, int dir);
+
+/**
+ * @brief Rotate the current block, shifting it by up to two columns if it does not fit.
+ *
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void rotate_block_game(Game *g);
+
+/**
+ * @brief Make the current block fall instantaneously: it is locked by the next tick.
+ *
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void fall_block_game(Game *g);
+
+/**
+ * @brief Copy a game into another one.
+ *
+ * @param dst destination game pointer.
+ * @param src source game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void copy_game(Game *dst, Game *src);
+
+/**
+ * @brief Move the current block to a placement and make it fall: it is locked by the next tick.
+ *
+ * @param g game pointer.
+ * @param p placement.
+ * @return false if the block could not reach the placement, true otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern bool place_block_game(Game *g, Placement p);
+
+/**
+ * @brief Return the interval between two ticks of gravity at the current level.
+ *
+ * @param g game pointer.
+ * @return interval in milliseconds.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int get_interval_game(Game *g);
+
+#endif
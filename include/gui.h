@@ -13,13 +13,24 @@
 #define GUI_H
 
 /**
- * @brief Init colors.
+ * @brief Init terminal.
+ *
+ * @param b terminal backend (enum gui_backend).
  *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
- * @since 1.0
+ * @version 1.1
+ * @since 1.1
+ */
+extern void init_gui(int b);
+
+/**
+ * @brief Restore terminal.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
  */
-extern void init_colors();
+extern void end_gui();
 
 /**
  * @brief Init windows.
@@ -290,6 +301,65 @@ extern int scroll_down_game_over_win();
  */
 extern int scroll_up_game_over_win();
 
+/**
+ * @brief Record the terminal output of each frame in the probes (enum probe): redrawn cells, written bytes and write() system calls.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void enable_accounting_gui();
+
+/**
+ * @brief Show or hide the debug overlay: frame rate, tick and render times, input queue, input-to-screen
+ * latency and terminal output per frame. It is also toggled by the O key.
+ *
+ * Nothing is measured for the overlay while it is hidden.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void toggle_overlay_gui();
+
+/**
+ * @brief Send all the windows updated since the last frame to the terminal with a single flush.
+ *
+ * Nothing is sent if no window changed, or if the previous frame is more recent than the frame rate cap allows.
+ *
+ * @return true if a frame has been sent, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern bool present_frame();
+
+/**
+ * @brief Wait for a pressed key, presenting pending frames in the meantime.
+ *
+ * The program exits when the input of the terminal backend is over.
+ *
+ * @return pressed key, or KEY_WAKEUP after wake_up_gui().
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int get_key();
+
+/**
+ * @brief Make get_key() return KEY_WAKEUP, so that the caller runs outside of a signal handler the
+ * work the handler requested.
+ *
+ * It only sets a flag, so it can be called from a signal handler.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void wake_up_gui();
+
 /**
  * @brief Change GUI global color.
  *
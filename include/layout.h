@@ -0,0 +1,139 @@
+/**
+ * @file layout.h
+ * @brief Layout and colors of the GUI, shared by the renderers.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+/**
+ * @addtogroup Utils
+ * @{
+ */
+#define CHAR_PER_CELL 2 /**<@brief Number of horizontal characters to represent a cell of the game area. */
+
+#define CURR_HEIGHT 24 /**< @brief Height of the main game area. */
+#define CURR_WIDTH 24 /**< @brief Width of the main game area. */
+#define NEXT_HEIGHT 7 /**< @brief Height of the next-block game area. */
+#define NEXT_WIDTH 12 /**< @brief Width of the next-block game area. */
+#define STATS_HEIGHT 3 /**< @brief Height of the game statistics windows. */
+#define STATS_WIDTH 12 /**< @brief Width of the game statistics windows. */
+#define HELP_HEIGHT 3 /**< @brief Height of the help box. */
+#define HELP_WIDTH 30 /**< @brief Width of the help box. */
+#define OVERLAY_HEIGHT 10 /**< @brief Height of the debug overlay. */
+#define OVERLAY_WIDTH 12 /**< @brief Width of the debug overlay. */
+#define OVERLAY_LINES (OVERLAY_HEIGHT - 2) /**< @brief Number of text lines of the debug overlay. */
+#define GAME_MENU_HEIGHT 5 /**< @brief Height of the game menu. */
+#define GAME_MENU_WIDTH 14 /**< @brief Width of the game menu. */
+#define MENU_BUTTON_HEIGHT 3 /**< @brief Height of main menu buttons. */
+#define MENU_BUTTON_WIDTH 17 /**< @brief Width of main menu buttons. */
+#define MENU_BUTTON_TOP 8 /**< @brief Row of the first main menu button, from the top of the main game area. */
+#define OPTIONS_HEIGHT 8 /**< @brief Height of options menu. */
+#define OPTIONS_WIDTH 24 /**< @brief Width of options menu. */
+#define RULES_HEIGHT 16 /**< @brief Height of the rules box. */
+#define RULES_WIDTH 50 /**< @brief Width of the rules box. */
+#define GAME_OVER_HEIGHT 4 /**< @brief Height of the game over menu. */
+#define GAME_OVER_WIDTH 14 /**< @brief Width of the game over menu. */
+#define GLOBAL_HEIGHT CURR_HEIGHT + HELP_HEIGHT + 2 /**< @brief Height of the global window. */
+#define GLOBAL_WIDTH NEXT_WIDTH + CURR_WIDTH + STATS_WIDTH + 2 /**< @brief Width of the global window. */
+#define TITLE_HEIGHT 7 /**< @brief Height of the title. */
+#define TITLE_WIDTH CURR_WIDTH + STATS_WIDTH + NEXT_WIDTH + 2 /**< @brief Width of the title. */
+
+/** @brief ASCII art of the title. */
+#define TITLE " _______     _        _        ____\n"\
+              "      /__   __/  _| |_     |_|      / ___\\\n"\
+              "         | | ___/_   _/___  _   __ / /\n"\
+              "         | |/ _ \\ | | |  _/| | / _/| |\n"\
+              "         | || __/ | | | |  | | \\ \\ \\ \\___\n"\
+              "         |_|\\___| |_| |_|  |_|/__/  \\____/\n"
+
+/**
+ * @enum gui_color
+ * @brief Global colors of the GUI.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.0
+ * @since 1.0
+ */
+enum gui_color {
+    GUI_COLOR_DEFAULT = 17,
+    GUI_COLOR_BLUE,
+    GUI_COLOR_BLACK
+};
+
+/**
+ * @enum color
+ * @brief Used colors.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.0
+ * @since 1.0
+ */
+enum color {
+    COLOR_NEW_BLACK = 20,
+    COLOR_NEW_WHITE,
+    COLOR_NEW_RED,
+    COLOR_NEW_GREEN,
+    COLOR_NEW_BLUE,
+    COLOR_NEW_CYAN,
+    COLOR_NEW_ORANGE,
+    COLOR_NEW_YELLOW,
+    COLOR_NEW_PURPLE,
+    COLOR_NEW_DARK_PURPLE,
+    COLOR_NEW_PINK,
+    COLOR_NEW_BROWN,
+};
+
+/**
+ * @brief RGB components of each color of enum color, scaled within the range [0, 1000].
+ */
+static const short COLOR_RGB[][3] = {
+    {0, 0, 0}, // COLOR_NEW_BLACK
+    {1000, 1000, 1000}, // COLOR_NEW_WHITE
+    {1000, 0, 0}, // COLOR_NEW_RED
+    {0, 1000, 0}, // COLOR_NEW_GREEN
+    {0, 0, 1000}, // COLOR_NEW_BLUE
+    {0, 1000, 1000}, // COLOR_NEW_CYAN
+    {1000, 400, 0}, // COLOR_NEW_ORANGE
+    {1000, 1000, 0}, // COLOR_NEW_YELLOW
+    {796, 0, 796}, // COLOR_NEW_PURPLE
+    {187, 39, 140}, // COLOR_NEW_DARK_PURPLE
+    {1000, 400, 1000}, // COLOR_NEW_PINK
+    {644, 200, 164} // COLOR_NEW_BROWN
+};
+
+/**
+ * @brief Pairs of foreground color, background color, indexed by block type or global GUI color.
+ * The background of GHOST follows the global GUI color.
+ */
+static const short PAIR_COLORS[][2] = {
+    {COLOR_NEW_BLACK, COLOR_NEW_BLACK}, // BG
+    {COLOR_NEW_BLACK, COLOR_NEW_PINK}, // F
+    {COLOR_NEW_BLACK, COLOR_NEW_PINK}, // F_R
+    {COLOR_NEW_BLACK, COLOR_NEW_PURPLE}, // I
+    {COLOR_NEW_BLACK, COLOR_NEW_RED}, // L
+    {COLOR_NEW_BLACK, COLOR_NEW_RED}, // L_R
+    {COLOR_NEW_BLACK, COLOR_NEW_ORANGE}, // N
+    {COLOR_NEW_BLACK, COLOR_NEW_ORANGE}, // N_R
+    {COLOR_NEW_BLACK, COLOR_NEW_CYAN}, // P
+    {COLOR_NEW_BLACK, COLOR_NEW_CYAN}, // P_R
+    {COLOR_NEW_BLACK, COLOR_NEW_GREEN}, // T
+    {COLOR_NEW_BLACK, COLOR_NEW_WHITE}, // U
+    {COLOR_NEW_BLACK, COLOR_NEW_BROWN}, // W
+    {COLOR_NEW_BLACK, COLOR_NEW_YELLOW}, // Y
+    {COLOR_NEW_BLACK, COLOR_NEW_YELLOW}, // Y_R
+    {COLOR_NEW_BLACK, COLOR_NEW_PURPLE}, // I_SHORT
+    {COLOR_NEW_WHITE, COLOR_NEW_DARK_PURPLE}, // GHOST
+    {COLOR_NEW_WHITE, COLOR_NEW_DARK_PURPLE}, // GUI_COLOR_DEFAULT
+    {COLOR_NEW_WHITE, COLOR_NEW_BLUE}, // GUI_COLOR_BLUE
+    {COLOR_NEW_WHITE, COLOR_NEW_BLACK} // GUI_COLOR_BLACK
+};
+/** \} */
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file pool.h
+ * @brief Functions of a pool of threads that run the same task together, for the parallel searches.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+/**
+ * @brief Create a pool and start its threads, which wait for a task.
+ *
+ * @param threads number of threads, the calling one included, at most POOL_MAX_THREADS.
+ * @return pool pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Pool *create_pool(int threads);
+
+/**
+ * @brief Stop the threads of a pool and free it.
+ *
+ * @param p pool pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_pool(Pool *p);
+
+/**
+ * @brief Return the number of threads of a pool, the calling one included.
+ *
+ * @param p pool pointer.
+ * @return number of threads.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int get_threads_pool(Pool *p);
+
+/**
+ * @brief Run a task on every thread of a pool, the calling one being thread 0, and wait for all of them.
+ *
+ * @param p pool pointer.
+ * @param task task, called with its argument and the index of the thread.
+ * @param arg argument of the task.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void run_pool(Pool *p, void (*task)(void *arg, int id), void *arg);
+
+#endif
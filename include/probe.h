@@ -0,0 +1,113 @@
+/**
+ * @file probe.h
+ * @brief Latency histograms of the timer tick, the input handling and the rendering, and size histograms of the terminal output.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef PROBE_H
+#define PROBE_H
+
+/**
+ * @brief Init the histograms of the calling thread and set where they are dumped.
+ *
+ * Once a path is set, the histograms are also dumped when the process receives SIGUSR1.
+ *
+ * @param path file the histograms are appended to, NULL to never dump them.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void init_probes(const char *path);
+
+/**
+ * @brief Return the current time, to be passed to record_probe().
+ *
+ * @return monotonic time in nanoseconds.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern long get_time_probe();
+
+/**
+ * @brief Record the time elapsed since a start time in the histogram of a probe.
+ *
+ * Lock-free and async-signal-safe: each thread updates its own histograms.
+ *
+ * @param probe probe (enum probe).
+ * @param start start time returned by get_time_probe().
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void record_probe(int probe, long start);
+
+/**
+ * @brief Record a value in the histogram of a probe that does not measure a latency, e.g. a size.
+ *
+ * Lock-free and async-signal-safe, as record_probe().
+ *
+ * @param probe probe (enum probe).
+ * @param value non-negative value.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void record_value_probe(int probe, long value);
+
+/**
+ * @brief Return a percentile of the latencies of a probe, merged over all the threads.
+ *
+ * @param probe probe (enum probe).
+ * @param percentile percentile, between 0 and 100.
+ * @return latency in nanoseconds, with a relative error below 1/16; 0 if nothing was recorded.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern long get_percentile_probe(int probe, double percentile);
+
+/**
+ * @brief Return the number and the sum of the values recorded by a probe, merged over all the threads.
+ *
+ * The mean over an interval is the difference of two calls.
+ *
+ * @param probe probe (enum probe).
+ * @param count number of values, set at the end.
+ * @param sum sum of the values, set at the end.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void get_total_probe(int probe, long *count, long *sum);
+
+/**
+ * @brief Dump the percentiles of all the probes to the file set by init_probes().
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void dump_probes();
+
+/**
+ * @brief Dump the probes if SIGUSR1 was received since the last call.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void poll_probes();
+
+#endif
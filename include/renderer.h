@@ -0,0 +1,79 @@
+/**
+ * @file renderer.h
+ * @brief Interface of the terminal backends that draw the GUI.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#define KEY_EOF -2 /**< @brief Returned by get_key when there is no more input. */
+
+/**
+ * @addtogroup Utils
+ * @{
+ */
+
+/**
+ * @struct Renderer
+ * @brief Draw callbacks of a terminal backend.
+ *
+ * Draw callbacks update the frame being composed, present() sends it to the terminal.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    void (*init)(); /**< @brief Init terminal. */
+    void (*end)(); /**< @brief Restore terminal. */
+    void (*init_windows)(); /**< @brief Init windows. */
+    void (*change_global_color)(int color); /**< @brief Change GUI global color (enum gui_color). */
+    void (*draw_global_win)(); /**< @brief Draw global window. */
+    void (*draw_main_menu)(int select); /**< @brief Draw main menu, given the selected element. */
+    void (*draw_curr_field)(Field *f); /**< @brief Draw main game area. */
+    void (*draw_next_field)(Field *f); /**< @brief Draw next-block area. */
+    void (*draw_stats)(int level, int score, int rows); /**< @brief Draw game statistics. */
+    void (*draw_help)(); /**< @brief Draw help box. */
+    void (*draw_options)(int select, int ghost, int color); /**< @brief Draw options menu, given the selected element and the option values. */
+    void (*draw_rules)(int page); /**< @brief Draw rules box, given the current page. */
+    void (*draw_game_menu)(int select); /**< @brief Draw game menu, given the selected element. */
+    void (*draw_game_over)(int select); /**< @brief Draw game over menu, given the selected element. */
+    void (*draw_overlay)(int overlay, const char *title, const char *lines[], int count); /**< @brief Draw a panel of the debug overlay (enum overlay), given its text lines. */
+    void (*erase_overlay)(int overlay); /**< @brief Erase a panel of the debug overlay (enum overlay). */
+    void (*present)(FrameOutput *out); /**< @brief Send the frame to the terminal, accounting its output in out if not NULL. */
+    int (*get_key)(int timeout_millis); /**< @brief Wait for a pressed key: ERR on timeout or interruption, KEY_EOF at the end of the input. */
+} Renderer;
+
+extern const Renderer NCURSES_RENDERER; /**< @brief Windows handled by ncurses. */
+extern const Renderer ANSI_RENDERER; /**< @brief Raw ANSI escape sequences. */
+extern const Renderer NULL_RENDERER; /**< @brief No output, keys read from the standard input. */
+/** \} */
+
+/**
+ * @brief Init ncurses colors and color pairs.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.0
+ * @since 1.0
+ */
+extern void init_colors();
+
+/**
+ * @brief Read a key from the standard input, decoding arrow escape sequences to ncurses key codes.
+ *
+ * @param timeout_millis max waiting time in milliseconds, -1 to wait indefinitely.
+ * @return pressed key, ERR on timeout or interruption, KEY_EOF at the end of the input.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int read_stdin_key(int timeout_millis);
+
+#endif
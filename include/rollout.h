@@ -0,0 +1,69 @@
+/**
+ * @file rollout.h
+ * @brief Functions of a rollout planner, which values each placement by playing continuations of the game.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef ROLLOUT_H
+#define ROLLOUT_H
+
+/**
+ * @brief Create a planner, with the buffers of its continuations and its threads.
+ *
+ * @param w weights of the board features.
+ * @param candidates number of best placements of the falling block that are played out, 0 for all of them.
+ * @param rollouts number of continuations played from each placement.
+ * @param length number of blocks placed by each continuation, after the falling one.
+ * @param policy policy that places the blocks of the continuations (enum rollout_policy).
+ * @param threads number of threads that play the continuations, the calling one included, at most POOL_MAX_THREADS.
+ * @return planner pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Rollout *create_rollout(const Weights *w, int candidates, int rollouts, int length, int policy, int threads);
+
+/**
+ * @brief Stop the threads of a planner and free it.
+ *
+ * @param r planner pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_rollout(Rollout *r);
+
+/**
+ * @brief Find the placement of the falling block whose continuations survive most, then end on the best boards.
+ *
+ * @param r planner pointer.
+ * @param g game pointer.
+ * @return best placement.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Placement find_placement_rollout(Rollout *r, Game *g);
+
+/**
+ * @brief Play the current block: move it to the best placement and lock it, as play_block_bot().
+ *
+ * @param r planner pointer.
+ * @param g game pointer.
+ * @return outcome of the lock (enum tick_result).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int play_block_rollout(Rollout *r, Game *g);
+
+#endif
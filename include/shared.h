@@ -12,6 +12,9 @@
 #ifndef SHARED_H
 #define SHARED_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 /**
  * @brief Terminate with an error message.
  *
@@ -40,6 +43,7 @@
  */
 enum main_menu {
     NEW_GAME,
+    AUTOPLAY,
     OPTIONS,
     RULES,
     QUIT
@@ -140,6 +144,92 @@ enum game_over {
     GAME_OVER_RESTART,
     GAME_OVER_BACK
 };
+
+//                                                     BACKEND
+/*------------------------------------------------------------*/
+
+/**
+ * @enum gui_backend
+ * @brief Terminal backends to draw the GUI.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum gui_backend {
+    BACKEND_NCURSES, /**< @brief Windows handled by ncurses. */
+    BACKEND_ANSI, /**< @brief Raw ANSI escape sequences. */
+    BACKEND_NULL /**< @brief No output, keys read from the standard input. */
+};
+
+/**
+ * @struct FrameOutput
+ * @brief Terminal output of a frame.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    long cells; /**< @brief Number of redrawn cells. */
+    long bytes; /**< @brief Number of bytes written to the terminal. */
+    long flushes; /**< @brief Number of write() system calls. */
+} FrameOutput;
+
+#define KEY_WAKEUP -3 /**< @brief Returned by get_key() of the GUI when wake_up_gui() has been called meanwhile. */
+
+/**
+ * @enum overlay
+ * @brief Panels of the debug overlay.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum overlay {
+    OVERLAY_PERF, /**< @brief Frame rate, tick and render times, input queue and latency. */
+    OVERLAY_OUTPUT, /**< @brief Terminal output per frame. */
+    OVERLAYS /**< @brief Number of panels. */
+};
+
+//                                                       PROBE
+/*------------------------------------------------------------*/
+
+/**
+ * @enum probe
+ * @brief Measured code paths, each one with its latency histogram.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum probe {
+    PROBE_TICK, /**< @brief Timer tick handler. */
+    PROBE_KEY_UP, /**< @brief Rotation. */
+    PROBE_KEY_DOWN, /**< @brief Move down. */
+    PROBE_KEY_LEFT, /**< @brief Move left. */
+    PROBE_KEY_RIGHT, /**< @brief Move right. */
+    PROBE_KEY_SPACE, /**< @brief Instantaneous fall. */
+    PROBE_KEY_MENU, /**< @brief Game menu opening. */
+    PROBE_AUTOPLAY, /**< @brief Placement of a block by the autoplay bot. */
+    PROBE_REFRESH_GLOBAL, /**< @brief refresh_global_win(). */
+    PROBE_REFRESH_MAIN_MENU, /**< @brief refresh_main_menu(). */
+    PROBE_REFRESH_CURR_FIELD, /**< @brief refresh_curr_field_win(). */
+    PROBE_REFRESH_NEXT_FIELD, /**< @brief refresh_next_field_win(). */
+    PROBE_REFRESH_STATS, /**< @brief refresh_stats_win(). */
+    PROBE_REFRESH_HELP, /**< @brief refresh_help_win(). */
+    PROBE_REFRESH_OPTIONS, /**< @brief refresh_options_win(). */
+    PROBE_REFRESH_RULES, /**< @brief refresh_rules_win(). */
+    PROBE_REFRESH_GAME_MENU, /**< @brief refresh_game_menu(). */
+    PROBE_REFRESH_GAME_OVER, /**< @brief refresh_game_over_win(). */
+    PROBE_PRESENT, /**< @brief Frame sent to the terminal. */
+    PROBE_INPUT_TO_SCREEN, /**< @brief From a key read to the next frame sent to the terminal. */
+    PROBE_FRAME_CELLS, /**< @brief Cells redrawn per frame (not a latency). */
+    PROBE_FRAME_BYTES, /**< @brief Bytes written per frame (not a latency). */
+    PROBE_FRAME_FLUSHES, /**< @brief write() system calls per frame (not a latency). */
+    PROBE_WASTED_KEYS, /**< @brief Keys pressed per block beyond the shortest sequence to its final position (not a latency). */
+    PROBES /**< @brief Number of probes. */
+};
 /** \} */
 
 //                                                       FIELD
@@ -152,6 +242,7 @@ enum game_over {
 #define ROWS 22 /**< @brief Number of rows of the game area. */
 #define COLUMNS 11 /**< @brief Number of columns of the game area. */
 #define BLOCK_MAX_SIZE 5 /**< @brief Max number of cells that constitute a block. */
+#define ROTATION_MAX_CELLS 16 /**< @brief Max number of cells checked to rotate a block. */
 
 /**
  * @struct Field
@@ -227,6 +318,375 @@ typedef struct {
     int col; /**< @brief Rotation center column. */
     int mark; /**< @brief Mark to use to print the block. */
 } Block;
+
+//                                                        GAME
+/*------------------------------------------------------------*/
+
+#define LEVEL_CAP 10 /**< @brief Max level. */
+#define ROWS_PER_LEVEL 5 /**< @brief Number of completed rows required to level up. */
+#define SCORE_PER_ROW 100 /**< @brief Score for single row completed. */
+#define BONUS_EXPONENT 2 /**< @brief Bonus for multiple rows completed. */
+#define BONUS_GHOST_OFF 2 /**< @brief Bonus for disabling 'Ghost' option. */
+
+#define INIT_VALUE_MILLIS 800 /**< @brief Initial block fall interval in milliseconds. */
+#define INTERVAL_REDUCTION_PER_LEVEL_MILLIS 50 /**< @brief Interval per level to subtract from the current one in milliseconds. */
+
+/**
+ * @enum tick_result
+ * @brief Outcome of a tick of gravity.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum tick_result {
+    TICK_MOVED, /**< @brief The current block moved down. */
+    TICK_LOCKED, /**< @brief The current block was locked and a new block was dropped. */
+    TICK_GAME_OVER /**< @brief The current block was locked above the game area. */
+};
+
+/**
+ * @struct Game
+ * @brief Structure to represent a running game, independent of the GUI.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    Field *curr_field; /**< @brief Main game area. */
+    Field *next_field; /**< @brief Next-block area. */
+    Block *curr_block; /**< @brief Falling block. */
+    Block *ghost_block; /**< @brief Landing position of the falling block. */
+    Block *next_block; /**< @brief Next block. */
+    int level; /**< @brief Level. */
+    int rows; /**< @brief Number of total deleted rows. */
+    int score; /**< @brief Score. */
+    int ghost; /**< @brief Value of 'Ghost' option (enum ghost_option). */
+    unsigned int seed; /**< @brief State of the random number generator of the blocks. */
+} Game;
+
+#define STATE_BYTES 64 /**< @brief Size budget of a GameState: one cache line. */
+
+/**
+ * @struct GameState
+ * @brief Compact state of a running game, without pointers, that can be copied by assignment or memcpy().
+ *
+ * The main game area keeps the locked cells only, one bit per column, without their marks: the falling
+ * block is kept apart, and the ghost is not kept at all.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    uint16_t board[ROWS]; /**< @brief Locked cells of the main game area, bit i of a row set if column i is filled. */
+    unsigned int seed; /**< @brief State of the random number generator of the blocks. */
+    int score; /**< @brief Score. */
+    uint16_t rows; /**< @brief Number of total deleted rows. */
+    int8_t row; /**< @brief Rotation center row of the falling block. */
+    int8_t col; /**< @brief Rotation center column of the falling block. */
+    uint8_t type; /**< @brief Type of the falling block. */
+    uint8_t rot; /**< @brief Rotation of the falling block. */
+    uint8_t next_type; /**< @brief Type of the next block. */
+    uint8_t next_rot; /**< @brief Rotation of the next block. */
+    uint8_t level; /**< @brief Level. */
+    uint8_t ghost; /**< @brief Value of 'Ghost' option (enum ghost_option), for the score bonus. */
+} GameState;
+
+_Static_assert(sizeof(GameState) <= STATE_BYTES, "GameState exceeds its size budget");
+
+/**
+ * @struct Placement
+ * @brief Final position of the current block, reached from its spawn position.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int rotations; /**< @brief Number of rotations. */
+    int shift; /**< @brief Number of columns to move, negative to the left. */
+} Placement;
+
+#define MAX_SHIFT (COLUMNS / 2 + 1) /**< @brief Max number of columns a block can move from its spawn position. */
+#define PLACEMENT_COL_OFFSET BLOCK_MAX_SIZE /**< @brief Offset of the rotation center column of a locked block, to index the tried placements. */
+#define MAX_PLACEMENTS (4*COLUMNS) /**< @brief Max number of different final positions of a block: 4 rotations by at most COLUMNS columns. */
+
+/**
+ * @struct Undo
+ * @brief Record of a placement applied to a GameState, to undo it.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    unsigned int seed; /**< @brief Seed before the placement. */
+    int score_delta; /**< @brief Score gained. */
+    int result; /**< @brief Outcome of the lock (enum tick_result). */
+    int8_t row; /**< @brief Rotation center row of the block before the placement. */
+    int8_t col; /**< @brief Rotation center column of the block before the placement. */
+    uint8_t rot; /**< @brief Rotation of the block before the placement. */
+    int8_t lock_row; /**< @brief Rotation center row of the locked block. */
+    int8_t lock_col; /**< @brief Rotation center column of the locked block. */
+    uint8_t lock_rot; /**< @brief Rotation of the locked block. */
+    uint8_t type; /**< @brief Type of the block before the placement. */
+    uint8_t next_type; /**< @brief Type of the next block before the placement. */
+    uint8_t next_rot; /**< @brief Rotation of the next block before the placement. */
+    uint8_t level_delta; /**< @brief Levels gained. */
+    uint8_t cleared_count; /**< @brief Number of deleted rows. */
+    int8_t cleared[BLOCK_MAX_SIZE]; /**< @brief Indexes of the deleted rows, in the order of deletion. */
+} Undo;
+
+//                                                         BOT
+/*------------------------------------------------------------*/
+
+/**
+ * @struct Weights
+ * @brief Weights of the board features evaluated by the bot.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    double height; /**< @brief Weight of the sum of the column heights. */
+    double lines; /**< @brief Weight of the number of deleted rows. */
+    double holes; /**< @brief Weight of the number of empty cells below a filled one. */
+    double bumpiness; /**< @brief Weight of the sum of the height differences of adjacent columns. */
+    double row_transitions; /**< @brief Weight of the number of filled-empty changes along the rows, walls filled. */
+    double col_transitions; /**< @brief Weight of the number of filled-empty changes along the columns, floor filled. */
+    double wells; /**< @brief Weight of the number of open empty cells between two filled ones, or a filled one and a wall. */
+} Weights;
+
+#define BATCH_SIZE 48 /**< @brief Max number of boards evaluated at once, a multiple of the lanes of every kernel. */
+
+_Static_assert(MAX_PLACEMENTS <= BATCH_SIZE, "the final positions of a block do not fit in a batch");
+
+/**
+ * @enum features_kernel
+ * @brief Implementations of the extraction of the board features.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum features_kernel {
+    KERNEL_SCALAR, /**< @brief One board at a time. */
+    KERNEL_SSE2, /**< @brief 8 boards at a time. */
+    KERNEL_AVX2, /**< @brief 16 boards at a time. */
+    KERNELS
+};
+
+/**
+ * @struct BoardBatch
+ * @brief Boards evaluated at once, structure of arrays: the same row of all the boards is contiguous.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    uint16_t rows[ROWS][BATCH_SIZE]; /**< @brief Rows of the boards, as in GameState. */
+} BoardBatch;
+
+/**
+ * @struct FeatureBatch
+ * @brief Features of a batch of boards, structure of arrays.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int16_t height[BATCH_SIZE]; /**< @brief Sum of the column heights. */
+    int16_t holes[BATCH_SIZE]; /**< @brief Number of empty cells below a filled one. */
+    int16_t bumpiness[BATCH_SIZE]; /**< @brief Sum of the height differences of adjacent columns. */
+    int16_t row_transitions[BATCH_SIZE]; /**< @brief Number of filled-empty changes along the rows, walls filled. */
+    int16_t col_transitions[BATCH_SIZE]; /**< @brief Number of filled-empty changes along the columns, floor filled. */
+    int16_t wells[BATCH_SIZE]; /**< @brief Number of open empty cells between two filled ones, or a filled one and a wall. */
+} FeatureBatch;
+
+/**
+ * @struct Bot
+ * @brief Structure to represent a bot that plays a game.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    Weights weights; /**< @brief Weights of the board features. */
+    int depth; /**< @brief Number of blocks searched: 1 for the falling one, 2 to also place the next one. */
+    long deadline; /**< @brief End of the running search in nanoseconds (CLOCK_MONOTONIC), 0 if it has none. */
+    bool expired; /**< @brief The running search reached its deadline and was stopped. */
+} Bot;
+
+#define POOL_MAX_THREADS 64 /**< @brief Max number of threads of a pool. */
+
+/**
+ * @struct Pool
+ * @brief Pool of threads that run the same task together: see pool.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct Pool Pool;
+
+#define BEAM_MAX_WIDTH 256 /**< @brief Max number of boards kept by a beam search after each block. */
+#define BEAM_MAX_DEPTH 6 /**< @brief Max number of blocks placed by a beam search: the falling one, the next one and 4 more of the queue. */
+
+/**
+ * @struct Beam
+ * @brief Beam-search planner, with its buffers and its threads: see beam.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct Beam Beam;
+
+#define TABLE_DEFAULT_BYTES (8 << 20) /**< @brief Default memory budget of a transposition table, in bytes. */
+
+/**
+ * @struct Table
+ * @brief Transposition table shared by the threads of a search, without locks: see table.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct Table Table;
+
+#define EXPECTIMAX_MAX_DEPTH 4 /**< @brief Max number of blocks placed by an expectimax search: the falling one, the next one and 2 unknown ones. */
+
+/**
+ * @struct Expectimax
+ * @brief Expectimax planner, with its transposition table and its threads: see expectimax.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct Expectimax Expectimax;
+
+/**
+ * @enum rollout_policy
+ * @brief Policy that places the blocks of a continuation played by the rollout planner.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum rollout_policy {
+    ROLLOUT_RANDOM, /**< @brief Random rotation and shift. */
+    ROLLOUT_GREEDY /**< @brief Best board by weighted sum of features, as the bot with depth 1. */
+};
+
+/**
+ * @struct Rollout
+ * @brief Rollout planner, with its continuations and its threads: see rollout.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct Rollout Rollout;
+
+#define SOLVER_MAX_PIECES 32 /**< @brief Max number of blocks of the sequence given to the perfect-clear solver. */
+
+/**
+ * @struct Solver
+ * @brief Perfect-clear solver, with its visited set and its threads: see solver.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct Solver Solver;
+
+#define FINESSE_MAX_KEYS 16 /**< @brief Max number of keys of the shortest sequence to a final position, the last drop included. */
+
+/**
+ * @enum finesse_key
+ * @brief Game key pressed to move the falling block, as in the game loop of main.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum finesse_key {
+    FINESSE_ROTATE, /**< @brief Rotation, or fix of the block position if it does not fit (KEY_UP). */
+    FINESSE_LEFT, /**< @brief Move left (KEY_LEFT). */
+    FINESSE_RIGHT, /**< @brief Move right (KEY_RIGHT). */
+    FINESSE_DOWN, /**< @brief Move down (KEY_DOWN). */
+    FINESSE_DROP /**< @brief Instantaneous fall (KEY_SPACE). */
+};
+
+/**
+ * @struct Finesse
+ * @brief Planner of the shortest key sequences to the final positions of the falling block: see finesse.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct Finesse Finesse;
+
+#define VEC_ENV_MAX_ENVS 4096 /**< @brief Max number of games stepped at once by a vectorised environment. */
+#define VEC_ENV_SHIFTS (2*MAX_SHIFT + 1) /**< @brief Number of shifts of an action of a vectorised environment. */
+#define VEC_ENV_ACTIONS (4*VEC_ENV_SHIFTS) /**< @brief Number of actions of a vectorised environment: rotations by shifts. */
+#define VEC_ENV_ALIGNMENT 64 /**< @brief Alignment of the arrays of the buffer of a vectorised environment, in bytes. */
+
+/**
+ * @enum observation_cell
+ * @brief Content of a cell of an observation.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum observation_cell {
+    CELL_EMPTY, /**< @brief Empty cell. */
+    CELL_FILLED, /**< @brief Cell of a locked block. */
+    CELL_FALLING /**< @brief Cell of the falling block. */
+};
+
+/**
+ * @struct Observation
+ * @brief Observation of a game of a vectorised environment, written in place in the buffer of the trainer.
+ *
+ * An action is rotations*VEC_ENV_SHIFTS + shift + MAX_SHIFT, for the placement with those rotations
+ * and that shift.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    uint8_t cells[ROWS][COLUMNS]; /**< @brief Cells of the game area (enum observation_cell). */
+    uint8_t legal[VEC_ENV_ACTIONS]; /**< @brief 1 if the action places the falling block as given, 0 if its shift is blocked. */
+    uint8_t type; /**< @brief Type of the falling block. */
+    uint8_t rot; /**< @brief Rotation of the falling block. */
+    uint8_t next_type; /**< @brief Type of the next block. */
+    uint8_t next_rot; /**< @brief Rotation of the next block. */
+    uint8_t level; /**< @brief Level. */
+    uint8_t reserved[1]; /**< @brief Padding to a multiple of 4 bytes. */
+} Observation;
+
+_Static_assert(sizeof(Observation) % 4 == 0, "the observations are not aligned to 4 bytes");
+
+/**
+ * @struct VecEnv
+ * @brief Vectorised environment, which steps many games at once for a trainer: see vec_env.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct VecEnv VecEnv;
 /** \} */
 
 #endif
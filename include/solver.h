@@ -0,0 +1,71 @@
+/**
+ * @file solver.h
+ * @brief Functions of a perfect-clear solver: place a fixed sequence of blocks so that the board is emptied.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+/**
+ * @brief Create a solver, with its visited set and its threads.
+ *
+ * @param threads number of threads that search the placements of the first block, the calling one included.
+ * @param table_bytes memory budget of the visited set, 0 for TABLE_DEFAULT_BYTES.
+ * @return solver pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Solver *create_solver(int threads, size_t table_bytes);
+
+/**
+ * @brief Stop the threads of a solver and free it.
+ *
+ * @param sv solver pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_solver(Solver *sv);
+
+/**
+ * @brief Find placements of a sequence of blocks that empty the board, or prove that there are none.
+ *
+ * Each block falls from the top of the game area in rotation 0, as spawn_block_state(); the falling
+ * block of the state is ignored. The solution is the first one in the order of the placements, whatever
+ * the number of threads.
+ *
+ * @param sv solver pointer.
+ * @param s state pointer: its board.
+ * @param types types of the blocks, in order.
+ * @param count number of blocks, at most SOLVER_MAX_PIECES: the program exits on a longer sequence.
+ * @param solution placements of the blocks of the solution, at least count of them.
+ * @return number of blocks placed by the solution (0 if the board is empty), or -1 if there is none.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int solve_solver(Solver *sv, const GameState *s, const uint8_t types[], int count, Placement solution[]);
+
+/**
+ * @brief Return the number of boards searched by the last call of solve_solver().
+ *
+ * @param sv solver pointer.
+ * @return number of boards.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern long get_nodes_solver(Solver *sv);
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * @file state.h
+ * @brief Functions to run a game on its compact state, with the same rules as game.h, for the search of the bots.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef STATE_H
+#define STATE_H
+
+/**
+ * @brief Init state: reset statistics and game area, and drop the first block, as init_game().
+ *
+ * @param s state pointer.
+ * @param ghost value of 'Ghost' option (enum ghost_option).
+ * @param seed seed of the random number generator of the blocks.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void init_state(GameState *s, int ghost, unsigned int seed);
+
+/**
+ * @brief Write the state of a game.
+ *
+ * @param s state pointer.
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void pack_state(GameState *s, Game *g);
+
+/**
+ * @brief Write the blocks that will fall after the current one, in order, without drawing them.
+ *
+ * The blocks are drawn from a generator seeded at the start of the game, so the whole queue is
+ * known in advance; the first one is the next block.
+ *
+ * @param s state pointer.
+ * @param count number of blocks.
+ * @param types types of the blocks.
+ * @param rots rotations of the blocks.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void get_queue_state(GameState *s, int count, uint8_t types[], uint8_t rots[]);
+
+/**
+ * @brief Replace the falling block with a given one at the top of the game area, as it falls after a lock.
+ *
+ * Used to search the blocks that are not known yet; the next block and the generator are unchanged.
+ *
+ * @param s state pointer.
+ * @param type block type.
+ * @param rot block rotation.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void spawn_block_state(GameState *s, int type, int rot);
+
+/**
+ * @brief Draw the next block, and the blocks after it, from a new seed; the falling block is unchanged.
+ *
+ * Used to sample the blocks that are not known yet.
+ *
+ * @param s state pointer.
+ * @param seed seed of the generator.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void reseed_state(GameState *s, unsigned int seed);
+
+/**
+ * @brief Apply a tick of gravity, as tick_game().
+ *
+ * @param s state pointer.
+ * @return outcome of the tick (enum tick_result).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern int tick_state(GameState *s);
+
+/**
+ * @brief Move the falling block, if possible, as move_block_game().
+ *
+ * @param s state pointer.
+ * @param dir direction.
+ * @return true if the block moved, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern bool move_block_state(GameState *s, int dir);
+
+/**
+ * @brief Rotate the falling block, fixing its position if it does not fit, as rotate_block_game().
+ *
+ * @param s state pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void rotate_block_state(GameState *s);
+
+/**
+ * @brief Move the falling block down as far as possible, as fall_block_game().
+ *
+ * @param s state pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void fall_block_state(GameState *s);
+
+/**
+ * @brief Move the falling block to a placement and let it fall, without locking it, as place_block_game().
+ *
+ * @param s state pointer.
+ * @param p placement.
+ * @return true if the block reached the placement, false if it was blocked on the way.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern bool place_block_state(GameState *s, Placement p);
+
+/**
+ * @brief Move the falling block to a placement, let it fall and lock it, recording how to undo it.
+ *
+ * A placement whose block locks above the game area is applied, with outcome TICK_GAME_OVER,
+ * and nothing is locked.
+ *
+ * @param s state pointer.
+ * @param p placement.
+ * @param u record filled to undo the placement.
+ * @return true if the block reached the placement, false if it was blocked on the way and the state is unchanged.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern bool apply_placement_state(GameState *s, Placement p, Undo *u);
+
+/**
+ * @brief Undo the last placement applied to a state, restoring it exactly.
+ *
+ * @param s state pointer.
+ * @param u record filled by apply_placement_state().
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void undo_placement_state(GameState *s, Undo *u);
+
+#endif
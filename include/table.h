@@ -0,0 +1,120 @@
+/**
+ * @file table.h
+ * @brief Functions of a transposition table shared by the threads of a search, without locks.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef TABLE_H
+#define TABLE_H
+
+/**
+ * @brief Create a table of empty entries, as many as fit in a memory budget (a power of 2).
+ *
+ * @param bytes memory budget in bytes, 0 for TABLE_DEFAULT_BYTES.
+ * @return table pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Table *create_table(size_t bytes);
+
+/**
+ * @brief Free a table.
+ *
+ * @param t table pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_table(Table *t);
+
+/**
+ * @brief Return the number of entries of a table.
+ *
+ * @param t table pointer.
+ * @return number of entries.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern size_t get_size_table(Table *t);
+
+/**
+ * @brief Start a new search: the entries of the previous searches are replaced first.
+ *
+ * Not thread-safe: called between two searches.
+ *
+ * @param t table pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void age_table(Table *t);
+
+/**
+ * @brief Hash the board of a state and, optionally, its falling block.
+ *
+ * @param s state pointer.
+ * @param block true to hash the type, rotation and position of the falling block too.
+ * @return hash.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern uint64_t hash_state_table(const GameState *s, bool block);
+
+/**
+ * @brief Mix a value into a hash.
+ *
+ * @param h hash.
+ * @param v value.
+ * @return new hash.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern uint64_t mix_hash_table(uint64_t h, uint64_t v);
+
+/**
+ * @brief Look up a key. Safe against concurrent stores: a torn entry is a miss.
+ *
+ * @param t table pointer.
+ * @param key key.
+ * @param value value of the entry, written on a hit.
+ * @param depth depth of the entry, written on a hit, or NULL.
+ * @param best best placement of the entry, written on a hit, or NULL.
+ * @return true on a hit.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern bool probe_table(Table *t, uint64_t key, double *value, int *depth, Placement *best);
+
+/**
+ * @brief Store an entry, unless its slot holds a deeper entry of the current search.
+ *
+ * @param t table pointer.
+ * @param key key.
+ * @param value value.
+ * @param depth depth of the search behind the value, from 0 to 255.
+ * @param best best placement, or {0, 0}.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void store_table(Table *t, uint64_t key, double value, int depth, Placement best);
+
+#endif
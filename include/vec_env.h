@@ -0,0 +1,151 @@
+/**
+ * @file vec_env.h
+ * @brief Functions of a vectorised environment, which steps many headless games at once for a trainer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#ifndef VEC_ENV_H
+#define VEC_ENV_H
+
+/**
+ * @brief Return the size of the buffer of a vectorised environment.
+ *
+ * The buffer holds the observations (Observation), then the rewards (float), then the done flags
+ * (uint8_t), one per game; each array starts at a multiple of VEC_ENV_ALIGNMENT bytes.
+ *
+ * @param count number of games.
+ * @return size in bytes.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern size_t get_buffer_size_vec_env(int count);
+
+/**
+ * @brief Allocate a buffer in shared memory, which another process can map without copies.
+ *
+ * The memory is an anonymous file (memfd_create()), inherited by the children of the process: a
+ * trainer maps the file descriptor, or /proc/<pid>/fd/<fd>, with MAP_SHARED.
+ *
+ * @param count number of games.
+ * @param fd file descriptor of the memory, written.
+ * @return buffer pointer, of get_buffer_size_vec_env() bytes.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void *map_shared_vec_env(int count, int *fd);
+
+/**
+ * @brief Free a buffer allocated by map_shared_vec_env().
+ *
+ * @param buffer buffer pointer.
+ * @param count number of games.
+ * @param fd file descriptor of the memory.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void unmap_shared_vec_env(void *buffer, int count, int fd);
+
+/**
+ * @brief Create a vectorised environment, with its threads, and start its games.
+ *
+ * The program exits if the number of games or of threads is out of range.
+ *
+ * @param count number of games, from 1 to VEC_ENV_MAX_ENVS.
+ * @param seeds seed of each game: the games after a game over are drawn from it, so that each game
+ * replays the same sequence of games.
+ * @param threads number of threads that step the games, the calling one included, from 1 to POOL_MAX_THREADS.
+ * @param buffer buffer of the caller, of get_buffer_size_vec_env() bytes, written in place.
+ * @return environment pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern VecEnv *create_vec_env(int count, const unsigned int seeds[], int threads, void *buffer);
+
+/**
+ * @brief Stop the threads of a vectorised environment and free it; the buffer is left to the caller.
+ *
+ * @param v environment pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void delete_vec_env(VecEnv *v);
+
+/**
+ * @brief Return the observations of a vectorised environment, in its buffer.
+ *
+ * @param v environment pointer.
+ * @return observations, one per game.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern Observation *get_observations_vec_env(VecEnv *v);
+
+/**
+ * @brief Return the rewards of the last step of a vectorised environment, in its buffer.
+ *
+ * @param v environment pointer.
+ * @return rewards, one per game: the number of rows deleted by the step.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern float *get_rewards_vec_env(VecEnv *v);
+
+/**
+ * @brief Return the done flags of the last step of a vectorised environment, in its buffer.
+ *
+ * @param v environment pointer.
+ * @return flags, one per game: 1 if the step ended the game, which was then started again.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern uint8_t *get_dones_vec_env(VecEnv *v);
+
+/**
+ * @brief Start new games in all the games of a vectorised environment, and write their observations.
+ *
+ * @param v environment pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void reset_vec_env(VecEnv *v);
+
+/**
+ * @brief Place the falling block of every game of a vectorised environment, and write the results in its buffer.
+ *
+ * A game that ends is started again at once, and its observation is the first one of the new game. The
+ * step does not allocate, and does not depend on the number of threads.
+ *
+ * @param v environment pointer.
+ * @param actions action of each game (see Observation); an action whose shift is blocked places the
+ * block with its rotations only.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+extern void step_vec_env(VecEnv *v, const int actions[]);
+
+#endif
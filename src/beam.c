@@ -0,0 +1,264 @@
+/**
+ * @file beam.c
+ * @brief Functions of a beam-search planner, which places the falling block looking ahead in the queue.
+ *
+ * The planner expands every placement of the falling block, keeps the best boards by weighted sum of
+ * features, and expands each of them with the next block of the queue, and so on. The blocks after the
+ * next one are drawn from the generator of the state, so the whole queue is known. The layers are
+ * written in buffers allocated with the planner, and may be expanded by the threads of a pool, each one
+ * on its own boards: a search does not allocate, and does not depend on the number of threads.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "shared.h"
+#include "game.h"
+#include "state.h"
+#include "feature.h"
+#include "bot.h"
+#include "pool.h"
+#include "beam.h"
+
+
+/**
+ * @struct Node
+ * @brief Board reached by a sequence of placements.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    GameState state; /**< @brief State after the placements. */
+    Placement first; /**< @brief Placement of the falling block at the root of the search. */
+    double value; /**< @brief Weighted sum of the board features, with the rows deleted since the root. */
+} Node;
+
+/**
+ * @struct Candidate
+ * @brief Child of a layer, sorted to select the next layer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    double value; /**< @brief Value of the child. */
+    int index; /**< @brief Index of the child in the children buffer. */
+} Candidate;
+
+struct Beam {
+    Weights weights; /**< @brief Weights of the board features. */
+    int width; /**< @brief Number of boards kept after each block. */
+    int depth; /**< @brief Number of blocks placed. */
+    Pool *pool; /**< @brief Threads that expand each layer, the calling one included. */
+    Node *layer; /**< @brief Boards of the current layer, width of them. */
+    int count; /**< @brief Number of boards of the current layer. */
+    Node *children; /**< @brief Children of the current layer, MAX_PLACEMENTS per board. */
+    int *child_counts; /**< @brief Number of children of each board of the current layer. */
+    Candidate *candidates; /**< @brief Children of the current layer, sorted by value. */
+    int root_rows; /**< @brief Number of deleted rows at the root of the search. */
+    bool root; /**< @brief The current layer is the root: its children are the placements of the falling block. */
+};
+
+/**
+ * @brief Expand a board of the current layer: write its children, one per final position of the next block.
+ *
+ * Placements that end the game are dropped.
+ *
+ * @param b planner pointer.
+ * @param i board index.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void expand_node(Beam *b, int i) {
+    Node *node = &b->layer[i];
+    Node *children = &b->children[i*MAX_PLACEMENTS];
+    GameState s = node->state;
+    bool tried[4][COLUMNS + 2*PLACEMENT_COL_OFFSET] = {{false}};
+    BoardBatch batch;
+    FeatureBatch features;
+    int lines[MAX_PLACEMENTS];
+    int count = 0;
+    Undo u;
+    Placement p;
+    int k;
+    for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+        for (p.shift = -MAX_SHIFT; p.shift <= MAX_SHIFT; p.shift++) {
+            if (!apply_placement_state(&s, p, &u)) {
+                continue;
+            }
+            bool *seen = &tried[u.lock_rot][u.lock_col + PLACEMENT_COL_OFFSET];
+            if (!*seen && u.result == TICK_LOCKED) {
+                children[count].state = s;
+                children[count].first = b->root ? p : node->first;
+                lines[count] = s.rows - b->root_rows;
+                for (k = 0; k < ROWS; k++) {
+                    batch.rows[k][count] = s.board[k];
+                }
+                count++;
+            }
+            *seen = true;
+            undo_placement_state(&s, &u);
+        }
+    }
+    extract_features(&batch, count, &features);
+    for (k = 0; k < count; k++) {
+        children[k].value = evaluate_batch_bot(&features, k, lines[k], &b->weights);
+    }
+    b->child_counts[i] = count;
+}
+
+/**
+ * @brief Task of the pool: expand the share of the current layer of a thread.
+ *
+ * @param arg planner pointer.
+ * @param id thread index: the boards id, id + threads, and so on are expanded.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void expand_task(void *arg, int id) {
+    Beam *b = arg;
+    int threads = get_threads_pool(b->pool);
+    int i;
+    for (i = id; i < b->count; i += threads) {
+        expand_node(b, i);
+    }
+}
+
+/**
+ * @brief Compare two candidates: the higher value first, then the lower index, so that the order is total.
+ *
+ * @param a first candidate.
+ * @param b second candidate.
+ * @return negative if a comes first, positive otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int compare_candidates(const void *a, const void *b) {
+    const Candidate *x = a, *y = b;
+    if (x->value != y->value) {
+        return x->value < y->value ? 1 : -1;
+    }
+    return x->index - y->index;
+}
+
+/**
+ * @brief Replace the current layer with its best children.
+ *
+ * @param b planner pointer.
+ * @return number of children; if 0, the current layer is unchanged.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int select_children(Beam *b) {
+    int count = 0;
+    int i, k;
+    for (i = 0; i < b->count; i++) {
+        for (k = 0; k < b->child_counts[i]; k++) {
+            int index = i*MAX_PLACEMENTS + k;
+            b->candidates[count].value = b->children[index].value;
+            b->candidates[count].index = index;
+            count++;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+    qsort(b->candidates, count, sizeof(Candidate), compare_candidates);
+    b->count = count < b->width ? count : b->width;
+    for (i = 0; i < b->count; i++) {
+        b->layer[i] = b->children[b->candidates[i].index];
+    }
+    return count;
+}
+
+/**
+ * @brief Allocate a buffer, or exit.
+ *
+ * @param size size in bytes.
+ * @return buffer pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void *allocate(size_t size) {
+    void *p = malloc(size);
+    if (p == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    return p;
+}
+
+Beam *create_beam(const Weights *w, int width, int depth, int threads) {
+    Beam *b = allocate(sizeof(Beam));
+    b->weights = *w;
+    b->width = width < 1 ? 1 : (width > BEAM_MAX_WIDTH ? BEAM_MAX_WIDTH : width);
+    b->depth = depth < 1 ? 1 : (depth > BEAM_MAX_DEPTH ? BEAM_MAX_DEPTH : depth);
+    b->layer = allocate(b->width*sizeof(Node));
+    b->children = allocate(b->width*MAX_PLACEMENTS*sizeof(Node));
+    b->child_counts = allocate(b->width*sizeof(int));
+    b->candidates = allocate(b->width*MAX_PLACEMENTS*sizeof(Candidate));
+    b->count = 0;
+    b->pool = create_pool(threads);
+    return b;
+}
+
+void delete_beam(Beam *b) {
+    delete_pool(b->pool);
+    free(b->layer);
+    free(b->children);
+    free(b->child_counts);
+    free(b->candidates);
+    free(b);
+}
+
+Placement find_placement_beam(Beam *b, Game *g) {
+    Placement best = {0, 0};
+    pack_state(&b->layer[0].state, g);
+    b->layer[0].first = best;
+    b->count = 1;
+    b->root_rows = b->layer[0].state.rows;
+    int d;
+    for (d = 0; d < b->depth; d++) {
+        b->root = d == 0;
+        run_pool(b->pool, expand_task, b);
+        // if every placement of this block ends the game, the best board of the previous layer is kept
+        if (select_children(b) == 0) {
+            break;
+        }
+        best = b->layer[0].first;
+    }
+    return best;
+}
+
+int play_block_beam(Beam *b, Game *g) {
+    place_block_game(g, find_placement_beam(b, g));
+    int result;
+    do {
+        result = tick_game(g);
+    } while (result == TICK_MOVED);
+    return result;
+}
+/** \} */
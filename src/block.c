@@ -252,4 +252,22 @@ bool can_rotate_block(Block *b, Field *f) {
     }
     return true;
 }
+
+int get_cells_block(Block *b, int cells[][2]) {
+    int i;
+    for (i = 1; i < COORD[0]; i += 2) {
+        cells[i / 2][0] = COORD[i];
+        cells[i / 2][1] = COORD[i + 1];
+    }
+    return COORD[0] / 2;
+}
+
+int get_rotation_cells_block(Block *b, int cells[][2]) {
+    int i;
+    for (i = 1; i < ROT_CHECK[0]; i += 2) {
+        cells[i / 2][0] = ROT_CHECK[i];
+        cells[i / 2][1] = ROT_CHECK[i + 1];
+    }
+    return ROT_CHECK[0] / 2;
+}
 /** \} */
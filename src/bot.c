@@ -0,0 +1,258 @@
+/**
+ * @file bot.c
+ * @brief Functions of a bot that chooses the placement of each block.
+ *
+ * The bot tries every rotation and column of the current block on a copy of the compact state of the
+ * game, and keeps the placement whose board, after the lock, has the best weighted sum of features.
+ * With a time budget, the search is deepened one block at a time, and a search that reaches the
+ * deadline is dropped in favour of the last complete one.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <float.h>
+#include <time.h>
+
+#include "shared.h"
+#include "field.h"
+#include "block.h"
+#include "game.h"
+#include "state.h"
+#include "feature.h"
+#include "bot.h"
+
+
+#define MAX_DEPTH 2 /**< @brief Max number of blocks searched: the falling one and the next one. */
+
+const Weights DEFAULT_WEIGHTS = {
+    -0.51, // height
+    0.76, // lines
+    -0.36, // holes
+    -0.18, // bumpiness
+    0, // row transitions
+    0, // column transitions
+    0 // wells
+};
+
+Bot *create_bot(const Weights *w) {
+    Bot *bot = malloc(sizeof(Bot));
+    if (bot == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    bot->weights = *w;
+    bot->depth = 1;
+    bot->deadline = 0;
+    bot->expired = false;
+    return bot;
+}
+
+void delete_bot(Bot *b) {
+    free(b);
+}
+
+double evaluate_field_bot(Field *f, int lines, const Weights *w) {
+    int height = 0, holes = 0, bumpiness = 0;
+    int prev_height = 0;
+    int row, col;
+    for (col = 0; col < f->cols; col++) {
+        // first filled cell from the top
+        row = 0;
+        while (row < f->rows && f->grid[row][col] == BG) {
+            row++;
+        }
+        int col_height = f->rows - row;
+        // empty cells below it
+        for (; row < f->rows; row++) {
+            if (f->grid[row][col] == BG) {
+                holes++;
+            }
+        }
+        height += col_height;
+        if (col > 0) {
+            bumpiness += abs(col_height - prev_height);
+        }
+        prev_height = col_height;
+    }
+    return w->height*height + w->lines*lines + w->holes*holes + w->bumpiness*bumpiness;
+}
+
+double evaluate_batch_bot(FeatureBatch *f, int i, int lines, const Weights *w) {
+    return w->height*f->height[i] + w->lines*lines + w->holes*f->holes[i] + w->bumpiness*f->bumpiness[i]
+           + w->row_transitions*f->row_transitions[i] + w->col_transitions*f->col_transitions[i] + w->wells*f->wells[i];
+}
+
+double evaluate_state_bot(GameState *s, int lines, const Weights *w) {
+    BoardBatch batch;
+    FeatureBatch features;
+    int row;
+    for (row = 0; row < ROWS; row++) {
+        batch.rows[row][0] = s->board[row];
+    }
+    extract_features(&batch, 1, &features);
+    return evaluate_batch_bot(&features, 0, lines, w);
+}
+
+/**
+ * @brief Return the time of CLOCK_MONOTONIC in nanoseconds.
+ *
+ * @return nanoseconds.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long now_nanos() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec*1000000000L + now.tv_nsec;
+}
+
+/**
+ * @brief Depth-first search of the placements of the falling block, and of the next ones, on a single state.
+ *
+ * Each placement is applied and then undone, so that the state is never copied. Before each subtree,
+ * the deadline of the bot is checked: once it is reached, the search stops and its result is meaningless.
+ *
+ * @param b bot pointer.
+ * @param s state pointer, unchanged on return.
+ * @param depth number of blocks to place.
+ * @param rows number of deleted rows at the root of the search.
+ * @param best best placement of the falling block, or NULL.
+ * @return value of the best board after the last placement.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static double search_bot(Bot *b, GameState *s, int depth, int rows, Placement *best) {
+    double best_value = -DBL_MAX;
+    // final positions already evaluated, by rotation and column
+    bool tried[4][COLUMNS + 2*PLACEMENT_COL_OFFSET] = {{false}};
+    // boards of the last block, evaluated at once
+    BoardBatch batch;
+    FeatureBatch features;
+    Placement leaves[BATCH_SIZE];
+    int lines[BATCH_SIZE];
+    int count = 0;
+    Undo u;
+    Placement p;
+    int i;
+    for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+        for (p.shift = -MAX_SHIFT; p.shift <= MAX_SHIFT; p.shift++) {
+            if (!apply_placement_state(s, p, &u)) {
+                continue;
+            }
+            bool *seen = &tried[u.lock_rot][u.lock_col + PLACEMENT_COL_OFFSET];
+            if (*seen) {
+                undo_placement_state(s, &u);
+                continue;
+            }
+            *seen = true;
+
+            // the board of the state does not contain the block that has just been dropped
+            double value;
+            if (u.result == TICK_GAME_OVER) {
+                value = -DBL_MAX / 2;
+            }
+            else if (depth > 1) {
+                if (b->deadline > 0 && (b->expired || now_nanos() >= b->deadline)) {
+                    b->expired = true;
+                    undo_placement_state(s, &u);
+                    return best_value;
+                }
+                value = search_bot(b, s, depth - 1, rows, NULL);
+            }
+            else {
+                for (i = 0; i < ROWS; i++) {
+                    batch.rows[i][count] = s->board[i];
+                }
+                leaves[count] = p;
+                lines[count] = s->rows - rows;
+                count++;
+                undo_placement_state(s, &u);
+                continue;
+            }
+            undo_placement_state(s, &u);
+            if (value > best_value) {
+                best_value = value;
+                if (best != NULL) {
+                    *best = p;
+                }
+            }
+        }
+    }
+
+    extract_features(&batch, count, &features);
+    for (i = 0; i < count; i++) {
+        double value = evaluate_batch_bot(&features, i, lines[i], &b->weights);
+        if (value > best_value) {
+            best_value = value;
+            if (best != NULL) {
+                *best = leaves[i];
+            }
+        }
+    }
+    return best_value;
+}
+
+Placement find_placement_bot(Bot *b, Game *g) {
+    Placement best = {0, 0};
+    GameState s;
+    pack_state(&s, g);
+    // after the next block, the blocks are not known
+    search_bot(b, &s, b->depth < MAX_DEPTH ? b->depth : MAX_DEPTH, s.rows, &best);
+    return best;
+}
+
+Placement find_placement_timed_bot(Bot *b, Game *g, long budget_nanos) {
+    Placement best = {0, 0}, p;
+    GameState s;
+    pack_state(&s, g);
+    int max_depth = b->depth < MAX_DEPTH ? b->depth : MAX_DEPTH;
+    int depth;
+    // the budget counts from the start, the shallowest search included
+    long deadline = now_nanos() + budget_nanos;
+    // the shallowest search always completes, so that there is a placement
+    b->deadline = 0;
+    b->expired = false;
+    search_bot(b, &s, 1, s.rows, &best);
+    b->deadline = deadline;
+    for (depth = 2; depth <= max_depth; depth++) {
+        search_bot(b, &s, depth, s.rows, &p);
+        if (b->expired) {
+            break;
+        }
+        best = p;
+    }
+    b->deadline = 0;
+    return best;
+}
+
+int play_block_bot(Bot *b, Game *g) {
+    place_block_game(g, find_placement_bot(b, g));
+    int result;
+    do {
+        result = tick_game(g);
+    } while (result == TICK_MOVED);
+    return result;
+}
+
+int play_block_state_bot(Bot *b, GameState *s) {
+    Placement best = {0, 0};
+    Undo u;
+    search_bot(b, s, b->depth < MAX_DEPTH ? b->depth : MAX_DEPTH, s->rows, &best);
+    apply_placement_state(s, best, &u);
+    return u.result;
+}
+/** \} */
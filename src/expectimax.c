@@ -0,0 +1,362 @@
+/**
+ * @file expectimax.c
+ * @brief Functions of an expectimax planner, which averages over the blocks that are not shown yet.
+ *
+ * The falling block and the next one are known; every block after them is drawn uniformly among the
+ * I_SHORT types, so the planner places the known blocks (max nodes) and averages over the types of
+ * the unknown ones (chance nodes). The game also draws the rotation of a block, but a chance node
+ * spawns each type in rotation 0 only: the placements reach the 4 rotations of a block from any of
+ * them, and only a rotation blocked by the walls or the stack sets the drawn one apart. To bound the
+ * cost of a move, only the best placements of a block by weighted sum of features are searched
+ * further, and the search stops at the depth of the planner, with no other cutoff: every chance node
+ * within it is searched, whatever its probability. The value of a node depends only on its board, its
+ * falling block if known, the rows deleted since the root and the number of blocks left, so it is
+ * cached in a transposition table that lasts across moves, with the best placement of a max node. The
+ * placements of the falling block are shared among the threads of a pool, which share the table too:
+ * a board reached under two placements of the falling block is searched once.
+ *
+ * A board and its mirror image are keyed apart, although the blocks come in mirror pairs: the rotation
+ * is clockwise only, fix_block_position() tries the left side first and the rotation centers of the
+ * blocks are not symmetric, so the placements reached on a mirrored board are not the mirrored ones,
+ * and neither is its value.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <float.h>
+
+#include "shared.h"
+#include "game.h"
+#include "state.h"
+#include "feature.h"
+#include "bot.h"
+#include "pool.h"
+#include "table.h"
+#include "expectimax.h"
+
+
+#define LOSS_VALUE -1e9 /**< @brief Value of a board where the game is over, below the value of any board. */
+
+/**
+ * @enum node_kind
+ * @brief Kind of a node of the search, part of its key in the transposition table.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+enum node_kind {
+    NODE_ROOT = 1, /**< @brief Falling block of the game, with the next one known. */
+    NODE_MAX, /**< @brief Known falling block, the following ones unknown. */
+    NODE_CHANCE /**< @brief Unknown falling block. */
+};
+
+/**
+ * @struct Child
+ * @brief Board reached by a placement of the falling block.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    GameState state; /**< @brief State after the placement. */
+    Placement placement; /**< @brief Placement. */
+    double value; /**< @brief Weighted sum of the board features, with the rows deleted since the root. */
+    int index; /**< @brief Order of the placement, to sort the children with equal value. */
+} Child;
+
+struct Expectimax {
+    Weights weights; /**< @brief Weights of the board features. */
+    int depth; /**< @brief Number of blocks placed. */
+    int branching; /**< @brief Number of best placements searched further. */
+    Pool *pool; /**< @brief Threads that search the placements of the falling block. */
+    Table *table; /**< @brief Transposition table, shared by the threads. */
+    int root_rows; /**< @brief Number of deleted rows at the root of the search. */
+    Child roots[MAX_PLACEMENTS]; /**< @brief Placements of the falling block, best first. */
+    int root_count; /**< @brief Number of placements of the falling block searched. */
+    double values[MAX_PLACEMENTS]; /**< @brief Expected values of the placements of the falling block. */
+};
+
+static double search_chance(Expectimax *e, GameState *s, int plies);
+
+/**
+ * @brief Compare two children: the higher value first, then the lower index.
+ *
+ * @param a first child.
+ * @param b second child.
+ * @return negative if a comes first, positive otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int compare_children(const void *a, const void *b) {
+    const Child *x = a, *y = b;
+    if (x->value != y->value) {
+        return x->value < y->value ? 1 : -1;
+    }
+    return x->index - y->index;
+}
+
+/**
+ * @brief Write the boards reached by the placements of the falling block, best first.
+ *
+ * Placements that end the game are dropped.
+ *
+ * @param e planner pointer.
+ * @param s state pointer.
+ * @param children children, at least MAX_PLACEMENTS of them.
+ * @return number of children.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int expand(Expectimax *e, GameState *s, Child children[]) {
+    bool tried[4][COLUMNS + 2*PLACEMENT_COL_OFFSET] = {{false}};
+    BoardBatch batch;
+    FeatureBatch features;
+    int lines[MAX_PLACEMENTS];
+    int count = 0;
+    Undo u;
+    Placement p;
+    int k;
+    for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+        for (p.shift = -MAX_SHIFT; p.shift <= MAX_SHIFT; p.shift++) {
+            if (!apply_placement_state(s, p, &u)) {
+                continue;
+            }
+            bool *seen = &tried[u.lock_rot][u.lock_col + PLACEMENT_COL_OFFSET];
+            if (!*seen && u.result == TICK_LOCKED) {
+                children[count].state = *s;
+                children[count].placement = p;
+                children[count].index = count;
+                lines[count] = s->rows - e->root_rows;
+                for (k = 0; k < ROWS; k++) {
+                    batch.rows[k][count] = s->board[k];
+                }
+                count++;
+            }
+            *seen = true;
+            undo_placement_state(s, &u);
+        }
+    }
+    extract_features(&batch, count, &features);
+    for (k = 0; k < count; k++) {
+        children[k].value = evaluate_batch_bot(&features, k, lines[k], &e->weights);
+    }
+    qsort(children, count, sizeof(Child), compare_children);
+    return count;
+}
+
+/**
+ * @brief Key of a node: its board, its falling block if it is a max node, the rows deleted since the root and the number of blocks left.
+ *
+ * @param s state pointer.
+ * @param lines number of rows deleted since the root.
+ * @param plies number of blocks left to place.
+ * @param kind node kind (enum node_kind).
+ * @return key.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static uint64_t hash_node(GameState *s, int lines, int plies, int kind) {
+    uint64_t h = hash_state_table(s, kind != NODE_CHANCE);
+    if (kind == NODE_ROOT) {
+        // the root is the only node whose next block is known and searched
+        h = mix_hash_table(h, s->next_type);
+        h = mix_hash_table(h, s->next_rot);
+    }
+    h = mix_hash_table(h, (uint32_t)lines);
+    h = mix_hash_table(h, plies);
+    return mix_hash_table(h, kind);
+}
+
+/**
+ * @brief Value of the board reached by a placement, once the following blocks are placed.
+ *
+ * @param e planner pointer.
+ * @param c child pointer.
+ * @param known true if the falling block of the child is known (the next block of the game).
+ * @param plies number of blocks left to place, the falling one of the child included.
+ * @return value.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static double search_child(Expectimax *e, Child *c, bool known, int plies);
+
+/**
+ * @brief Max node: value of the best placement of the falling block of a state.
+ *
+ * @param e planner pointer.
+ * @param s state pointer, unchanged on return.
+ * @param plies number of blocks left to place, the falling one included.
+ * @return value.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static double search_max(Expectimax *e, GameState *s, int plies) {
+    uint64_t key = hash_node(s, s->rows - e->root_rows, plies, NODE_MAX);
+    double best;
+    if (probe_table(e->table, key, &best, NULL, NULL)) {
+        return best;
+    }
+    Child children[MAX_PLACEMENTS];
+    int count = expand(e, s, children);
+    Placement placement = {0, 0};
+    if (count == 0) {
+        best = LOSS_VALUE;
+    }
+    else if (plies == 1) {
+        best = children[0].value;
+        placement = children[0].placement;
+    }
+    else {
+        best = -DBL_MAX;
+        int i;
+        for (i = 0; i < count && i < e->branching; i++) {
+            // the blocks after the next one are unknown
+            double value = search_child(e, &children[i], false, plies - 1);
+            if (value > best) {
+                best = value;
+                placement = children[i].placement;
+            }
+        }
+    }
+    store_table(e->table, key, best, plies, placement);
+    return best;
+}
+
+static double search_child(Expectimax *e, Child *c, bool known, int plies) {
+    if (known) {
+        return search_max(e, &c->state, plies);
+    }
+    return search_chance(e, &c->state, plies);
+}
+
+/**
+ * @brief Chance node: mean value over the types of the falling block of a state, which is not known.
+ *
+ * @param e planner pointer.
+ * @param s state pointer.
+ * @param plies number of blocks left to place, the falling one included.
+ * @return value.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static double search_chance(Expectimax *e, GameState *s, int plies) {
+    uint64_t key = hash_node(s, s->rows - e->root_rows, plies, NODE_CHANCE);
+    double mean;
+    if (probe_table(e->table, key, &mean, NULL, NULL)) {
+        return mean;
+    }
+    // the blocks are drawn uniformly: every type has the same probability, and spawns in rotation 0
+    mean = 0;
+    GameState c;
+    int type;
+    for (type = 1; type <= I_SHORT; type++) {
+        c = *s;
+        spawn_block_state(&c, type, 0);
+        mean += search_max(e, &c, plies) / I_SHORT;
+    }
+    Placement none = {0, 0};
+    store_table(e->table, key, mean, plies, none);
+    return mean;
+}
+
+/**
+ * @brief Task of the pool: search the share of the placements of the falling block of a thread.
+ *
+ * @param arg planner pointer.
+ * @param id thread index: the placements id, id + threads, and so on are searched.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void search_task(void *arg, int id) {
+    Expectimax *e = arg;
+    int threads = get_threads_pool(e->pool);
+    int i;
+    for (i = id; i < e->root_count; i += threads) {
+        // the next block is shown in the preview
+        e->values[i] = e->depth == 1 ? e->roots[i].value : search_child(e, &e->roots[i], true, e->depth - 1);
+    }
+}
+
+Expectimax *create_expectimax(const Weights *w, int depth, int branching, int threads, size_t table_bytes) {
+    Expectimax *e = malloc(sizeof(Expectimax));
+    if (e == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    e->weights = *w;
+    e->depth = depth < 1 ? 1 : (depth > EXPECTIMAX_MAX_DEPTH ? EXPECTIMAX_MAX_DEPTH : depth);
+    e->branching = branching < 1 ? 1 : branching;
+    e->pool = create_pool(threads);
+    e->table = create_table(table_bytes);
+    return e;
+}
+
+void delete_expectimax(Expectimax *e) {
+    delete_pool(e->pool);
+    delete_table(e->table);
+    free(e);
+}
+
+Placement find_placement_expectimax(Expectimax *e, Game *g) {
+    Placement best = {0, 0};
+    GameState s;
+    pack_state(&s, g);
+    e->root_rows = s.rows;
+    age_table(e->table);
+    uint64_t key = hash_node(&s, 0, e->depth, NODE_ROOT);
+    double best_value;
+    if (probe_table(e->table, key, &best_value, NULL, &best)) {
+        return best;
+    }
+    int count = expand(e, &s, e->roots);
+    e->root_count = count < e->branching ? count : e->branching;
+    run_pool(e->pool, search_task, e);
+    // the first of the best placements, in the order of their boards
+    best_value = -DBL_MAX;
+    int i;
+    for (i = 0; i < e->root_count; i++) {
+        if (e->values[i] > best_value) {
+            best_value = e->values[i];
+            best = e->roots[i].placement;
+        }
+    }
+    store_table(e->table, key, best_value, e->depth, best);
+    return best;
+}
+
+int play_block_expectimax(Expectimax *e, Game *g) {
+    place_block_game(g, find_placement_expectimax(e, g));
+    int result;
+    do {
+        result = tick_game(g);
+    } while (result == TICK_MOVED);
+    return result;
+}
+/** \} */
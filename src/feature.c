@@ -0,0 +1,325 @@
+/**
+ * @file feature.c
+ * @brief Functions to extract the features of many boards at once, with SIMD kernels.
+ *
+ * Every feature is a sum over the rows of the population count of a bit mask, computed from the row,
+ * the row above and the union of the rows above (the covered columns): a column height is the number
+ * of rows where the column is covered, a height difference the number of rows where exactly one of
+ * two adjacent columns is covered. Boards are laid out as structure of arrays, so that a vector of
+ * 16-bit lanes holds the same row of 8 (SSE2) or 16 (AVX2) boards, and the population count is done
+ * with shifts and masks. The kernel is chosen at the first call, from the features of the CPU.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS /**< @brief The SIMD kernels are compiled. */
+#endif
+
+#include "shared.h"
+#include "feature.h"
+
+
+#define FULL_ROW ((1 << COLUMNS) - 1) /**< @brief Mask of the columns. */
+#define LAST_COLUMN (1 << (COLUMNS - 1)) /**< @brief Mask of the last column. */
+#define BUMP_MASK ((1 << (COLUMNS - 1)) - 1) /**< @brief Mask of the columns that have a right neighbour. */
+#define WALLS (1 | 1 << (COLUMNS + 1)) /**< @brief Walls around a row shifted left by one. */
+#define WALLED_MASK ((1 << (COLUMNS + 1)) - 1) /**< @brief Mask of the changes between the cells of a row with walls. */
+
+static void (*kernel_function)(BoardBatch *b, int count, FeatureBatch *f); /**< @brief Selected kernel. */
+static int kernel; /**< @brief Selected kernel (enum features_kernel). */
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT; /**< @brief Guard to select the kernel once. */
+
+/**
+ * @brief Extract the features of a board of a batch.
+ *
+ * @param b batch pointer.
+ * @param i board index.
+ * @param f features pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void extract_board(BoardBatch *b, int i, FeatureBatch *f) {
+    unsigned int covered = 0, above = 0;
+    int height = 0, holes = 0, bumpiness = 0, row_transitions = 0, col_transitions = 0, wells = 0;
+    int r;
+    for (r = 0; r < ROWS; r++) {
+        unsigned int row = b->rows[r][i];
+        // open empty cells, with a filled cell or a wall on both sides
+        wells += __builtin_popcount(~(row | covered) & FULL_ROW & (row << 1 | 1) & (row >> 1 | LAST_COLUMN));
+        covered |= row;
+        height += __builtin_popcount(covered);
+        holes += __builtin_popcount(covered & ~row);
+        bumpiness += __builtin_popcount((covered ^ covered >> 1) & BUMP_MASK);
+        unsigned int walled = row << 1 | WALLS;
+        row_transitions += __builtin_popcount((walled ^ walled >> 1) & WALLED_MASK);
+        col_transitions += __builtin_popcount(row ^ above);
+        above = row;
+    }
+    // the floor is filled
+    col_transitions += __builtin_popcount(~above & FULL_ROW);
+    f->height[i] = height;
+    f->holes[i] = holes;
+    f->bumpiness[i] = bumpiness;
+    f->row_transitions[i] = row_transitions;
+    f->col_transitions[i] = col_transitions;
+    f->wells[i] = wells;
+}
+
+/**
+ * @brief Scalar kernel: one board at a time.
+ *
+ * @param b batch pointer.
+ * @param count number of boards.
+ * @param f features pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void extract_scalar(BoardBatch *b, int count, FeatureBatch *f) {
+    int i;
+    for (i = 0; i < count; i++) {
+        extract_board(b, i, f);
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+/**
+ * @brief Count the bits of each 16-bit lane.
+ *
+ * @param x lanes.
+ * @return bit counts.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+__attribute__((target("sse2")))
+static __m128i popcount_sse2(__m128i x) {
+    x = _mm_sub_epi16(x, _mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi16(0x5555)));
+    x = _mm_add_epi16(_mm_and_si128(x, _mm_set1_epi16(0x3333)), _mm_and_si128(_mm_srli_epi16(x, 2), _mm_set1_epi16(0x3333)));
+    x = _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 4)), _mm_set1_epi16(0x0f0f));
+    return _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), _mm_set1_epi16(0x001f));
+}
+
+/**
+ * @brief SSE2 kernel: 8 boards at a time, the remaining ones with the scalar kernel.
+ *
+ * @param b batch pointer.
+ * @param count number of boards.
+ * @param f features pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+__attribute__((target("sse2")))
+static void extract_sse2(BoardBatch *b, int count, FeatureBatch *f) {
+    const __m128i full = _mm_set1_epi16(FULL_ROW);
+    const __m128i first = _mm_set1_epi16(1);
+    const __m128i last = _mm_set1_epi16(LAST_COLUMN);
+    const __m128i bump_mask = _mm_set1_epi16(BUMP_MASK);
+    const __m128i walls = _mm_set1_epi16(WALLS);
+    const __m128i walled_mask = _mm_set1_epi16(WALLED_MASK);
+    int i, r;
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m128i covered = _mm_setzero_si128(), above = _mm_setzero_si128();
+        __m128i height = _mm_setzero_si128(), holes = _mm_setzero_si128(), bumpiness = _mm_setzero_si128();
+        __m128i row_transitions = _mm_setzero_si128(), col_transitions = _mm_setzero_si128(), wells = _mm_setzero_si128();
+        for (r = 0; r < ROWS; r++) {
+            __m128i row = _mm_loadu_si128((__m128i *)&b->rows[r][i]);
+            __m128i sides = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(row, 1), first), _mm_or_si128(_mm_srli_epi16(row, 1), last));
+            __m128i open = _mm_andnot_si128(_mm_or_si128(row, covered), full);
+            wells = _mm_add_epi16(wells, popcount_sse2(_mm_and_si128(open, sides)));
+            covered = _mm_or_si128(covered, row);
+            height = _mm_add_epi16(height, popcount_sse2(covered));
+            holes = _mm_add_epi16(holes, popcount_sse2(_mm_andnot_si128(row, covered)));
+            __m128i steps = _mm_xor_si128(covered, _mm_srli_epi16(covered, 1));
+            bumpiness = _mm_add_epi16(bumpiness, popcount_sse2(_mm_and_si128(steps, bump_mask)));
+            __m128i walled = _mm_or_si128(_mm_slli_epi16(row, 1), walls);
+            __m128i changes = _mm_xor_si128(walled, _mm_srli_epi16(walled, 1));
+            row_transitions = _mm_add_epi16(row_transitions, popcount_sse2(_mm_and_si128(changes, walled_mask)));
+            col_transitions = _mm_add_epi16(col_transitions, popcount_sse2(_mm_xor_si128(row, above)));
+            above = row;
+        }
+        // the floor is filled
+        col_transitions = _mm_add_epi16(col_transitions, popcount_sse2(_mm_andnot_si128(above, full)));
+        _mm_storeu_si128((__m128i *)&f->height[i], height);
+        _mm_storeu_si128((__m128i *)&f->holes[i], holes);
+        _mm_storeu_si128((__m128i *)&f->bumpiness[i], bumpiness);
+        _mm_storeu_si128((__m128i *)&f->row_transitions[i], row_transitions);
+        _mm_storeu_si128((__m128i *)&f->col_transitions[i], col_transitions);
+        _mm_storeu_si128((__m128i *)&f->wells[i], wells);
+    }
+    for (; i < count; i++) {
+        extract_board(b, i, f);
+    }
+}
+
+/**
+ * @brief Count the bits of each 16-bit lane.
+ *
+ * @param x lanes.
+ * @return bit counts.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+__attribute__((target("avx2")))
+static __m256i popcount_avx2(__m256i x) {
+    x = _mm256_sub_epi16(x, _mm256_and_si256(_mm256_srli_epi16(x, 1), _mm256_set1_epi16(0x5555)));
+    x = _mm256_add_epi16(_mm256_and_si256(x, _mm256_set1_epi16(0x3333)), _mm256_and_si256(_mm256_srli_epi16(x, 2), _mm256_set1_epi16(0x3333)));
+    x = _mm256_and_si256(_mm256_add_epi16(x, _mm256_srli_epi16(x, 4)), _mm256_set1_epi16(0x0f0f));
+    return _mm256_and_si256(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), _mm256_set1_epi16(0x001f));
+}
+
+/**
+ * @brief AVX2 kernel: 16 boards at a time, the remaining ones with the scalar kernel.
+ *
+ * @param b batch pointer.
+ * @param count number of boards.
+ * @param f features pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+__attribute__((target("avx2")))
+static void extract_avx2(BoardBatch *b, int count, FeatureBatch *f) {
+    const __m256i full = _mm256_set1_epi16(FULL_ROW);
+    const __m256i first = _mm256_set1_epi16(1);
+    const __m256i last = _mm256_set1_epi16(LAST_COLUMN);
+    const __m256i bump_mask = _mm256_set1_epi16(BUMP_MASK);
+    const __m256i walls = _mm256_set1_epi16(WALLS);
+    const __m256i walled_mask = _mm256_set1_epi16(WALLED_MASK);
+    int i, r;
+    for (i = 0; i + 16 <= count; i += 16) {
+        __m256i covered = _mm256_setzero_si256(), above = _mm256_setzero_si256();
+        __m256i height = _mm256_setzero_si256(), holes = _mm256_setzero_si256(), bumpiness = _mm256_setzero_si256();
+        __m256i row_transitions = _mm256_setzero_si256(), col_transitions = _mm256_setzero_si256(), wells = _mm256_setzero_si256();
+        for (r = 0; r < ROWS; r++) {
+            __m256i row = _mm256_loadu_si256((__m256i *)&b->rows[r][i]);
+            __m256i sides = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi16(row, 1), first), _mm256_or_si256(_mm256_srli_epi16(row, 1), last));
+            __m256i open = _mm256_andnot_si256(_mm256_or_si256(row, covered), full);
+            wells = _mm256_add_epi16(wells, popcount_avx2(_mm256_and_si256(open, sides)));
+            covered = _mm256_or_si256(covered, row);
+            height = _mm256_add_epi16(height, popcount_avx2(covered));
+            holes = _mm256_add_epi16(holes, popcount_avx2(_mm256_andnot_si256(row, covered)));
+            __m256i steps = _mm256_xor_si256(covered, _mm256_srli_epi16(covered, 1));
+            bumpiness = _mm256_add_epi16(bumpiness, popcount_avx2(_mm256_and_si256(steps, bump_mask)));
+            __m256i walled = _mm256_or_si256(_mm256_slli_epi16(row, 1), walls);
+            __m256i changes = _mm256_xor_si256(walled, _mm256_srli_epi16(walled, 1));
+            row_transitions = _mm256_add_epi16(row_transitions, popcount_avx2(_mm256_and_si256(changes, walled_mask)));
+            col_transitions = _mm256_add_epi16(col_transitions, popcount_avx2(_mm256_xor_si256(row, above)));
+            above = row;
+        }
+        // the floor is filled
+        col_transitions = _mm256_add_epi16(col_transitions, popcount_avx2(_mm256_andnot_si256(above, full)));
+        _mm256_storeu_si256((__m256i *)&f->height[i], height);
+        _mm256_storeu_si256((__m256i *)&f->holes[i], holes);
+        _mm256_storeu_si256((__m256i *)&f->bumpiness[i], bumpiness);
+        _mm256_storeu_si256((__m256i *)&f->row_transitions[i], row_transitions);
+        _mm256_storeu_si256((__m256i *)&f->col_transitions[i], col_transitions);
+        _mm256_storeu_si256((__m256i *)&f->wells[i], wells);
+    }
+    for (; i < count; i++) {
+        extract_board(b, i, f);
+    }
+}
+#endif
+
+/**
+ * @brief Check if the CPU supports a kernel.
+ *
+ * @param k kernel (enum features_kernel).
+ * @return true if it is supported, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool is_supported_kernel(int k) {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (k == KERNEL_SSE2) {
+        return __builtin_cpu_supports("sse2");
+    }
+    if (k == KERNEL_AVX2) {
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    return k == KERNEL_SCALAR;
+}
+
+/**
+ * @brief Select a kernel, without checks.
+ *
+ * @param k kernel (enum features_kernel).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void select_kernel(int k) {
+    kernel = k;
+    kernel_function = extract_scalar;
+#ifdef HAVE_X86_KERNELS
+    if (k == KERNEL_SSE2) {
+        kernel_function = extract_sse2;
+    }
+    else if (k == KERNEL_AVX2) {
+        kernel_function = extract_avx2;
+    }
+#endif
+}
+
+/**
+ * @brief Select the widest kernel supported by the CPU.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_kernel() {
+    int k = KERNELS - 1;
+    while (!is_supported_kernel(k)) {
+        k--;
+    }
+    select_kernel(k);
+}
+
+void extract_features(BoardBatch *b, int count, FeatureBatch *f) {
+    pthread_once(&kernel_once, init_kernel);
+    kernel_function(b, count, f);
+}
+
+int get_kernel_feature() {
+    pthread_once(&kernel_once, init_kernel);
+    return kernel;
+}
+
+bool set_kernel_feature(int k) {
+    pthread_once(&kernel_once, init_kernel);
+    if (k < 0 || k >= KERNELS || !is_supported_kernel(k)) {
+        return false;
+    }
+    select_kernel(k);
+    return true;
+}
+/** \} */
@@ -0,0 +1,339 @@
+/**
+ * @file finesse.c
+ * @brief Functions of a planner of the shortest key sequences that bring the falling block to its final positions.
+ *
+ * The planner searches breadth first the positions of the falling block reached by the keys of the game
+ * loop: rotation, which fixes the block position as fix_block_position() when the block does not fit,
+ * and moves left, right and down; from each position, the instantaneous fall gives a final position.
+ * The first sequence found for a final position is the shortest, and among the shortest ones the one
+ * that rotates first, as a player does. The keys are pressed faster than the fall: no tick moves the
+ * block meanwhile.
+ *
+ * A search runs on the surface of the board: every cell below a filled one is filled too. The final
+ * positions reached from above the surface are the same, and the search depends only on the surface
+ * profile and on the falling block, so its result is kept in a memo and reused whenever the same block
+ * falls on the same profile. A sequence found on the surface is replayed on the board itself; in the
+ * rare cases that it does not reach the same position (a rotation near an overhang), or that the block
+ * starts below the surface, the board itself is searched, without the memo.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "shared.h"
+#include "block.h"
+#include "state.h"
+#include "table.h"
+#include "finesse.h"
+
+
+#define MEMO_SIZE 256 /**< @brief Number of searches kept in the memo, a power of 2. */
+#define ROW_OFFSET BLOCK_MAX_SIZE /**< @brief Offset of the rotation center row of the falling block, which spawns above the game area. */
+#define POSITION_ROWS (ROWS + 2*ROW_OFFSET) /**< @brief Number of rows of the rotation center of the falling block. */
+#define POSITION_COLUMNS (COLUMNS + 2*PLACEMENT_COL_OFFSET) /**< @brief Number of columns of the rotation center of the falling block. */
+#define MAX_POSITIONS (4*POSITION_ROWS*POSITION_COLUMNS) /**< @brief Max number of positions of the falling block. */
+
+/**
+ * @struct Landing
+ * @brief Final position of the falling block, with the shortest key sequence to it.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int8_t rot; /**< @brief Rotation. */
+    int8_t row; /**< @brief Rotation center row. */
+    int8_t col; /**< @brief Rotation center column. */
+    uint8_t count; /**< @brief Number of keys. */
+    uint8_t keys[FINESSE_MAX_KEYS]; /**< @brief Keys (enum finesse_key). */
+} Landing;
+
+/**
+ * @struct Plan
+ * @brief Final positions reached by the falling block from a position, on a board.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    uint64_t key; /**< @brief Hash of the surface and of the falling block, 0 if not searched. */
+    int count; /**< @brief Number of final positions. */
+    Landing landings[MAX_PLACEMENTS]; /**< @brief Final positions, by number of keys. */
+} Plan;
+
+/**
+ * @struct Node
+ * @brief Position of the falling block reached by the search.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int8_t rot; /**< @brief Rotation. */
+    int8_t row; /**< @brief Rotation center row. */
+    int8_t col; /**< @brief Rotation center column. */
+    uint8_t key; /**< @brief Key pressed from the parent (enum finesse_key). */
+    uint8_t depth; /**< @brief Number of keys from the start. */
+    int16_t parent; /**< @brief Index of the parent in the queue, -1 for the start. */
+} Node;
+
+struct Finesse {
+    Plan memo[MEMO_SIZE]; /**< @brief Searches on the surfaces, by hash. */
+    Plan board_plan; /**< @brief Last search on a board itself. */
+    Node queue[MAX_POSITIONS]; /**< @brief Positions reached by the running search, in order. */
+    bool visited[4][POSITION_ROWS][POSITION_COLUMNS]; /**< @brief Positions already reached by the running search. */
+    long hits; /**< @brief Number of calls answered by the memo. */
+    long lookups; /**< @brief Number of calls. */
+};
+
+/**
+ * @brief Find a final position among the ones of a plan.
+ *
+ * @param plan plan pointer.
+ * @param rot rotation.
+ * @param row rotation center row.
+ * @param col rotation center column.
+ * @return landing pointer, or NULL if it is not reached.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static Landing *find_landing(Plan *plan, int rot, int row, int col) {
+    int i;
+    for (i = 0; i < plan->count; i++) {
+        Landing *l = &plan->landings[i];
+        if (l->rot == rot && l->row == row && l->col == col) {
+            return l;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Move the falling block of a state to a position.
+ *
+ * @param s state pointer.
+ * @param n position.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void set_position(GameState *s, Node *n) {
+    s->rot = n->rot;
+    s->row = n->row;
+    s->col = n->col;
+}
+
+/**
+ * @brief Search breadth first the final positions reached by the falling block of a state.
+ *
+ * @param f planner pointer.
+ * @param start state pointer, with the falling block at the start position.
+ * @param plan final positions, written.
+ * @param target final position that stops the search, or NULL to reach all of them.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void search_plan(Finesse *f, const GameState *start, Plan *plan, Landing *target) {
+    memset(f->visited, 0, sizeof(f->visited));
+    plan->count = 0;
+    Node first = {start->rot, start->row, start->col, 0, 0, -1};
+    f->queue[0] = first;
+    f->visited[first.rot][first.row + ROW_OFFSET][first.col + PLACEMENT_COL_OFFSET] = true;
+    int head, tail = 1;
+    for (head = 0; head < tail; head++) {
+        Node *n = &f->queue[head];
+        GameState s = *start;
+        set_position(&s, n);
+        press_key_finesse(&s, FINESSE_DROP);
+        if (n->depth < FINESSE_MAX_KEYS && plan->count < MAX_PLACEMENTS && find_landing(plan, s.rot, s.row, s.col) == NULL) {
+            Landing *l = &plan->landings[plan->count++];
+            l->rot = s.rot;
+            l->row = s.row;
+            l->col = s.col;
+            l->count = n->depth + 1;
+            l->keys[n->depth] = FINESSE_DROP;
+            int i, index = head;
+            for (i = n->depth - 1; i >= 0; i--) {
+                l->keys[i] = f->queue[index].key;
+                index = f->queue[index].parent;
+            }
+            if (target != NULL && l->rot == target->rot && l->row == target->row && l->col == target->col) {
+                return;
+            }
+        }
+
+        int key;
+        for (key = FINESSE_ROTATE; key <= FINESSE_DOWN; key++) {
+            s = *start;
+            set_position(&s, n);
+            press_key_finesse(&s, key);
+            bool *seen = &f->visited[s.rot][s.row + ROW_OFFSET][s.col + PLACEMENT_COL_OFFSET];
+            if (*seen) {
+                continue;
+            }
+            *seen = true;
+            Node child = {s.rot, s.row, s.col, key, n->depth + 1, head};
+            f->queue[tail++] = child;
+        }
+    }
+}
+
+/**
+ * @brief Check if the falling block of a state is below the surface of its board.
+ *
+ * @param s state pointer, whose board is a surface.
+ * @return true if a cell of the block is filled.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool is_below_surface(GameState *s) {
+    Block b;
+    int cells[BLOCK_MAX_SIZE][2];
+    init_block(&b, s->type, s->rot, s->row, s->col);
+    int count = get_cells_block(&b, cells);
+    int i;
+    for (i = 0; i < count; i++) {
+        int row = s->row + cells[i][0];
+        if (row >= 0 && (s->board[row] & (1 << (s->col + cells[i][1])))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Check if a key sequence brings the falling block of a state to its final position.
+ *
+ * @param s state pointer.
+ * @param l final position, with its key sequence.
+ * @return true if the sequence reaches the final position.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool replays_landing(const GameState *s, Landing *l) {
+    GameState c = *s;
+    int i;
+    for (i = 0; i < l->count; i++) {
+        press_key_finesse(&c, l->keys[i]);
+    }
+    return c.rot == l->rot && c.row == l->row && c.col == l->col;
+}
+
+Finesse *create_finesse() {
+    // the memo starts empty: no key is 0
+    Finesse *f = calloc(1, sizeof(Finesse));
+    if (f == NULL) {
+        ERROR_EXIT("calloc");
+    }
+    return f;
+}
+
+void delete_finesse(Finesse *f) {
+    free(f);
+}
+
+int find_keys_finesse(Finesse *f, const GameState *s, int rot, int row, int col, uint8_t keys[]) {
+    f->lookups++;
+    GameState surface = *s;
+    uint16_t filled = 0;
+    int i;
+    for (i = 0; i < ROWS; i++) {
+        filled |= s->board[i];
+        surface.board[i] = filled;
+    }
+
+    Landing *l = NULL;
+    if (!is_below_surface(&surface)) {
+        uint64_t key = hash_state_table(&surface, true);
+        Plan *plan = &f->memo[key & (MEMO_SIZE - 1)];
+        if (plan->key == key) {
+            f->hits++;
+        }
+        else {
+            search_plan(f, &surface, plan, NULL);
+            plan->key = key;
+        }
+        l = find_landing(plan, rot, row, col);
+        if (l != NULL && !replays_landing(s, l)) {
+            l = NULL;
+        }
+    }
+    if (l == NULL) {
+        Landing target = {rot, row, col, 0, {0}};
+        search_plan(f, s, &f->board_plan, &target);
+        l = find_landing(&f->board_plan, rot, row, col);
+        if (l == NULL) {
+            return -1;
+        }
+    }
+    memcpy(keys, l->keys, l->count);
+    return l->count;
+}
+
+int find_placement_keys_finesse(Finesse *f, const GameState *s, Placement p, uint8_t keys[]) {
+    GameState c = *s;
+    if (!place_block_state(&c, p)) {
+        return -1;
+    }
+    return find_keys_finesse(f, s, c.rot, c.row, c.col, keys);
+}
+
+int count_wasted_keys_finesse(Finesse *f, const GameState *s, int rot, int row, int col, int pressed) {
+    uint8_t keys[FINESSE_MAX_KEYS];
+    int count = find_keys_finesse(f, s, rot, row, col, keys);
+    if (count < 0) {
+        return -1;
+    }
+    // the ticks may save the player the last drop
+    return pressed > count ? pressed - count : 0;
+}
+
+void press_key_finesse(GameState *s, int key) {
+    switch (key) {
+        case FINESSE_ROTATE:
+            rotate_block_state(s);
+            break;
+        case FINESSE_LEFT:
+            move_block_state(s, LEFT);
+            break;
+        case FINESSE_RIGHT:
+            move_block_state(s, RIGHT);
+            break;
+        case FINESSE_DOWN:
+            move_block_state(s, DOWN);
+            break;
+        case FINESSE_DROP:
+            fall_block_state(s);
+            break;
+    }
+}
+
+void get_stats_finesse(Finesse *f, long *hits, long *lookups) {
+    *hits = f->hits;
+    *lookups = f->lookups;
+}
+/** \} */
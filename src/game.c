@@ -0,0 +1,307 @@
+/**
+ * @file game.c
+ * @brief Functions to run a game: gravity, moves, row deletion and score.
+ *
+ * A game does not depend on the GUI, so that many of them can be simulated at the same time.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "shared.h"
+#include "field.h"
+#include "block.h"
+#include "game.h"
+
+
+/**
+ * @struct GameStorage
+ * @brief Memory of a game, allocated at once: the game, its game areas and its blocks.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    Game game; /**< @brief Game, first so that its pointer is the pointer of the storage. */
+    Field fields[2]; /**< @brief Main and next-block areas. */
+    Block blocks[3]; /**< @brief Current, ghost and next blocks. */
+} GameStorage;
+
+/**
+ * @brief Init next block with a random type and rotation.
+ *
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_next_block(Game *g) {
+    int type = rand_r(&g->seed) % I_SHORT + 1;
+    int rot = rand_r(&g->seed) % 4;
+    init_block(g->next_block, type, rot, BLOCK_MAX_SIZE / 2, BLOCK_MAX_SIZE / 2);
+}
+
+/**
+ * @brief Create new block.
+ *
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.0
+ */
+static void drop_block(Game *g) {
+    // init ghost if the option is enabled
+    if (g->ghost == OPT_GHOST_ON) {
+        init_ghost_block(g->ghost_block, g->next_block->type, g->next_block->rot, -BLOCK_MAX_SIZE, COLUMNS / 2);
+        // move down to position the ghost
+        while (can_move_block(g->ghost_block, g->curr_field, DOWN)) {
+            move_block(g->ghost_block, g->curr_field, DOWN);
+        }
+        write_block(g->ghost_block, g->curr_field);
+    }
+
+    // init current block
+    init_block(g->curr_block, g->next_block->type, g->next_block->rot, -BLOCK_MAX_SIZE, COLUMNS / 2);
+    // move down until the first cell of the block appears on the screen
+    while (get_limit_high_block(g->curr_block) < 0 && can_move_block(g->curr_block, g->curr_field, DOWN)) {
+        move_block(g->curr_block, g->curr_field, DOWN);
+    }
+    write_block(g->curr_block, g->curr_field);
+
+    // init next block
+    init_next_block(g);
+
+    clear_field(g->next_field);
+    write_block(g->next_block, g->next_field);
+}
+
+/**
+ * @brief Update 'Ghost'.
+ *
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.0
+ */
+static void update_ghost(Game *g) {
+    if (g->ghost != OPT_GHOST_ON) {
+        return;
+    }
+    update_block(g->ghost_block, g->curr_field, g->curr_block->rot, g->curr_block->row, g->curr_block->col);
+    while (can_move_block(g->ghost_block, g->curr_field, DOWN)) {
+        move_block(g->ghost_block, g->curr_field, DOWN);
+    }
+    // update curr_block to prevent the ghost from overwriting it in case of superposition
+    update_block(g->curr_block, g->curr_field, g->curr_block->rot, g->curr_block->row, g->curr_block->col);
+}
+
+/**
+ * @brief Fix block position after failed rotation.
+ *
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.0
+ */
+static void fix_block_position(Game *g) {
+    Block *b = g->curr_block;
+    Field *f = g->curr_field;
+    // if possible, move left
+    if (can_move_block(b, f, LEFT)) {
+        move_block(b, f, LEFT);
+        // if possible, rotate
+        if (can_rotate_block(b, f)) {
+            rotate_block(b, f);
+        }
+        // if possible, move left again
+        else if (can_move_block(b, f, LEFT)) {
+            move_block(b, f, LEFT);
+            // if possible, rotate
+            if (can_rotate_block(b, f)) {
+                rotate_block(b, f);
+            }
+            // otherwise reset it to the initial position, by moving it twice to the right
+            else {
+                move_block(b, f, RIGHT);
+                move_block(b, f, RIGHT);
+            }
+        }
+        else {
+            // otherwise reset it to the initial position, by moving it once to the right
+            move_block(b, f, RIGHT);
+        }
+    }
+
+    // if possible, move right
+    if (can_move_block(b, f, RIGHT)) {
+        move_block(b, f, RIGHT);
+        // if possible, rotate
+        if (can_rotate_block(b, f)) {
+            rotate_block(b, f);
+        }
+        // if possible, move right again
+        else if (can_move_block(b, f, RIGHT)) {
+            move_block(b, f, RIGHT);
+            // if possible, rotate
+            if (can_rotate_block(b, f)) {
+                rotate_block(b, f);
+            }
+            // otherwise reset it to the initial position, by moving it twice to the left
+            else {
+                move_block(b, f, LEFT);
+                move_block(b, f, LEFT);
+            }
+        }
+        else {
+            // otherwise reset it to the initial position, by moving it once to the left
+            move_block(b, f, LEFT);
+            // the block cannot rotate, even after repositioning
+        }
+    }
+}
+
+Game *create_game() {
+    // one allocation for the game, its areas and its blocks, that init_game() resets in place
+    GameStorage *storage = malloc(sizeof(GameStorage));
+    if (storage == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    Game *game = &storage->game;
+    game->curr_field = &storage->fields[0];
+    game->next_field = &storage->fields[1];
+    game->curr_block = &storage->blocks[0];
+    game->ghost_block = &storage->blocks[1];
+    game->next_block = &storage->blocks[2];
+    return game;
+}
+
+void delete_game(Game *g) {
+    // the game is the first member of its storage
+    free(g);
+}
+
+void init_game(Game *g, int ghost, unsigned int seed) {
+    g->level = 1;
+    g->rows = 0;
+    g->score = 0;
+    g->ghost = ghost;
+    g->seed = seed;
+
+    init_field(g->curr_field, ROWS, COLUMNS);
+    init_field(g->next_field, BLOCK_MAX_SIZE, BLOCK_MAX_SIZE);
+
+    init_next_block(g);
+
+    drop_block(g);
+}
+
+int tick_game(Game *g) {
+    if (can_move_block(g->curr_block, g->curr_field, DOWN)) {
+        move_block(g->curr_block, g->curr_field, DOWN);
+        return TICK_MOVED;
+    }
+
+    // check if the whole block appears on the screen: if not it is game over
+    if (get_limit_low_block(g->curr_block) < 0) {
+        return TICK_GAME_OVER;
+    }
+
+    // find completed rows to delete by checking the ones occupied by curr_block
+    int row_to_clear = find_row_field(g->curr_field, get_limit_low_block(g->curr_block), get_limit_high_block(g->curr_block));
+    // count rows completed simultaneously
+    int rows_count = 0;
+    while (row_to_clear != -1) {
+        clear_row_field(g->curr_field, row_to_clear);
+        g->rows++;
+        // level up
+        if (g->rows % ROWS_PER_LEVEL == 0 && g->level < LEVEL_CAP) {
+            g->level++;
+        }
+        rows_count++;
+        row_to_clear = find_row_field(g->curr_field, get_limit_low_block(g->curr_block), get_limit_high_block(g->curr_block));
+    }
+
+    // update score with bonus
+    int bonus = (g->ghost == OPT_GHOST_OFF) ? BONUS_GHOST_OFF : 1;
+    g->score += SCORE_PER_ROW*(int)pow(rows_count, BONUS_EXPONENT)*bonus;
+
+    // drop new block
+    drop_block(g);
+    return TICK_LOCKED;
+}
+
+bool move_block_game(Game *g, int dir) {
+    if (!can_move_block(g->curr_block, g->curr_field, dir)) {
+        return false;
+    }
+    move_block(g->curr_block, g->curr_field, dir);
+    update_ghost(g);
+    return true;
+}
+
+void rotate_block_game(Game *g) {
+    if (can_rotate_block(g->curr_block, g->curr_field)) {
+        rotate_block(g->curr_block, g->curr_field);
+    }
+    else {
+        // fix block position
+        fix_block_position(g);
+    }
+    update_ghost(g);
+}
+
+void fall_block_game(Game *g) {
+    while (can_move_block(g->curr_block, g->curr_field, DOWN)) {
+        move_block(g->curr_block, g->curr_field, DOWN);
+    }
+    update_ghost(g);
+}
+
+void copy_game(Game *dst, Game *src) {
+    *dst->curr_field = *src->curr_field;
+    *dst->next_field = *src->next_field;
+    *dst->curr_block = *src->curr_block;
+    *dst->ghost_block = *src->ghost_block;
+    *dst->next_block = *src->next_block;
+    dst->level = src->level;
+    dst->rows = src->rows;
+    dst->score = src->score;
+    dst->ghost = src->ghost;
+    dst->seed = src->seed;
+}
+
+bool place_block_game(Game *g, Placement p) {
+    int i;
+    for (i = 0; i < p.rotations; i++) {
+        rotate_block_game(g);
+    }
+    for (i = 0; i < abs(p.shift); i++) {
+        if (!move_block_game(g, p.shift < 0 ? LEFT : RIGHT)) {
+            return false;
+        }
+    }
+    fall_block_game(g);
+    return true;
+}
+
+int get_interval_game(Game *g) {
+    return INIT_VALUE_MILLIS - INTERVAL_REDUCTION_PER_LEVEL_MILLIS*(g->level - 1);
+}
+/** \} */
@@ -2,8 +2,10 @@
  * @file gui.c
  * @brief Functions to draw the GUI.
  *
+ * The GUI state (selected elements, frame rate cap) is kept here, drawing is delegated to the selected Renderer.
+ *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
+ * @version 1.1
  * @since 1.0
  *
  * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
@@ -13,101 +15,38 @@
  * @addtogroup Utils
  * @{
  */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
 #include <ncurses.h>
 
 #include "shared.h"
+#include "layout.h"
+#include "renderer.h"
+#include "probe.h"
 #include "gui.h"
 
 
-#define CHAR_PER_CELL 2 /**<@brief Number of horizontal characters to represent a cell of the game area. */
-
-#define CURR_HEIGHT 24 /**< @brief Height of the main game area. */
-#define CURR_WIDTH 24 /**< @brief Width of the main game area. */
-#define NEXT_HEIGHT 7 /**< @brief Height of the next-block game area. */
-#define NEXT_WIDTH 12 /**< @brief Width of the next-block game area. */
-#define STATS_HEIGHT 3 /**< @brief Height of the game statistics windows. */
-#define STATS_WIDTH 12 /**< @brief Width of the game statistics windows. */
-#define HELP_HEIGHT 3 /**< @brief Height of the help box. */
-#define HELP_WIDTH 30 /**< @brief Width of the help box. */
-#define GAME_MENU_HEIGHT 5 /**< @brief Height of the game menu. */
-#define GAME_MENU_WIDTH 14 /**< @brief Width of the game menu. */
-#define MENU_BUTTON_HEIGHT 3 /**< @brief Height of main menu buttons. */
-#define MENU_BUTTON_WIDTH 17 /**< @brief Width of main menu buttons. */
-#define OPTIONS_HEIGHT 8 /**< @brief Height of options menu. */
-#define OPTIONS_WIDTH 24 /**< @brief Width of options menu. */
-#define RULES_HEIGHT 16 /**< @brief Height of the rules box. */
-#define RULES_WIDTH 50 /**< @brief Width of the rules box. */
-#define GAME_OVER_HEIGHT 4 /**< @brief Height of the game over menu. */
-#define GAME_OVER_WIDTH 14 /**< @brief Width of the game over menu. */
-#define GLOBAL_HEIGHT CURR_HEIGHT + HELP_HEIGHT + 2 /**< @brief Height of the global window. */
-#define GLOBAL_WIDTH NEXT_WIDTH + CURR_WIDTH + STATS_WIDTH + 2 /**< @brief Width of the global window. */
-#define TITLE_HEIGHT 7 /**< @brief Height of the title. */
-#define TITLE_WIDTH CURR_WIDTH + STATS_WIDTH + NEXT_WIDTH + 2 /**< @brief Width of the title. */
-
-/** @brief ASCII art of the title. */
-#define TITLE " _______     _        _        ____\n"\
-              "      /__   __/  _| |_     |_|      / ___\\\n"\
-              "         | | ___/_   _/___  _   __ / /\n"\
-              "         | |/ _ \\ | | |  _/| | / _/| |\n"\
-              "         | || __/ | | | |  | | \\ \\ \\ \\___\n"\
-              "         |_|\\___| |_| |_|  |_|/__/  \\____/\n"
+#define FRAME_RATE_CAP 60 /**< @brief Max number of frames per second sent to the terminal. */
+#define FRAME_INTERVAL_NANOS (1000000000L / FRAME_RATE_CAP) /**< @brief Min interval between two frames in nanoseconds. */
+#define MAX_WAIT_MILLIS (FRAME_INTERVAL_NANOS / 1000000 + 1) /**< @brief Max waiting time for a key in milliseconds: a frame made pending, or a wake-up requested, by the timer just before the wait is handled after at most this. */
+#define OVERLAY_INTERVAL_NANOS 250000000L /**< @brief Interval between two updates of the debug overlay in nanoseconds. */
+#define KEY_OVERLAY 'o' /**< @brief Key O: show or hide the debug overlay. */
+#define KEY_OVERLAY_UPPER 'O' /**< @brief Key O with shift or caps lock: show or hide the debug overlay. */
+#define NO_VALUE -1 /**< @brief Value of a metric without samples. */
 
 /**
- * @enum gui_color
- * @brief Global colors of the GUI.
- *
- * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
- * @since 1.0
+ * @brief Titles of the panels of the debug overlay, in the order of enum overlay.
  */
-enum gui_color {
-    GUI_COLOR_DEFAULT = 17,
-    GUI_COLOR_BLUE,
-    GUI_COLOR_BLACK
+static const char *OVERLAY_TITLES[OVERLAYS] = {
+    "Perf",
+    "Output"
 };
 
-/**
- * @enum color
- * @brief Used colors.
- *
- * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
- * @since 1.0
- */
-enum color {
-    COLOR_NEW_BLACK = 20,
-    COLOR_NEW_WHITE,
-    COLOR_NEW_RED,
-    COLOR_NEW_GREEN,
-    COLOR_NEW_BLUE,
-    COLOR_NEW_CYAN,
-    COLOR_NEW_ORANGE,
-    COLOR_NEW_YELLOW,
-    COLOR_NEW_PURPLE,
-    COLOR_NEW_DARK_PURPLE,
-    COLOR_NEW_PINK,
-    COLOR_NEW_BROWN,
-};
-
-// menu windows
-static WINDOW *global_win;
-static WINDOW *options_win;
-static WINDOW *rules_win;
-static WINDOW *new_game_button;
-static WINDOW *options_button;
-static WINDOW *rules_button;
-static WINDOW *quit_button;
-
-// game windows
-static WINDOW *curr_field_win;
-static WINDOW *next_field_win;
-static WINDOW *level_win;
-static WINDOW *score_win;
-static WINDOW *rows_win;
-static WINDOW *help_win;
-static WINDOW *game_menu_win;
-static WINDOW *game_over_win;
-
 // GUI element selectors
 static int main_menu_select;
 static int options_select;
@@ -117,45 +56,61 @@ static int rules_page_select;
 static int game_menu_select;
 static int game_over_select;
 
-static int global_color; /**< @brief Global GUI color. */
-
-void init_colors() {
-    start_color();
-    // RGB colors scaled within the range [0, 1000]
-    init_color(COLOR_NEW_BLACK, 0, 0, 0);
-    init_color(COLOR_NEW_WHITE, 1000, 1000, 1000);
-    init_color(COLOR_NEW_RED, 1000, 0, 0);
-    init_color(COLOR_NEW_GREEN, 0, 1000, 0);
-    init_color(COLOR_NEW_BLUE, 0, 0, 1000);
-    init_color(COLOR_NEW_CYAN, 0, 1000, 1000);
-    init_color(COLOR_NEW_ORANGE, 1000, 400, 0);
-    init_color(COLOR_NEW_YELLOW, 1000, 1000, 0);
-    init_color(COLOR_NEW_PURPLE, 796, 0, 796);
-    init_color(COLOR_NEW_DARK_PURPLE, 187, 39, 140);
-    init_color(COLOR_NEW_PINK, 1000, 400, 1000);
-    init_color(COLOR_NEW_BROWN, 644, 200, 164);
-
-    // pairs of foreground color, background color
-    init_pair(GUI_COLOR_DEFAULT, COLOR_NEW_WHITE, COLOR_NEW_DARK_PURPLE);
-    init_pair(GUI_COLOR_BLUE, COLOR_NEW_WHITE, COLOR_NEW_BLUE);
-    init_pair(GUI_COLOR_BLACK, COLOR_NEW_WHITE, COLOR_NEW_BLACK);
-    init_pair(BG, COLOR_NEW_BLACK, COLOR_NEW_BLACK);
-    init_pair(F, COLOR_NEW_BLACK, COLOR_NEW_PINK);
-    init_pair(F_R, COLOR_NEW_BLACK, COLOR_NEW_PINK);
-    init_pair(I, COLOR_NEW_BLACK, COLOR_NEW_PURPLE);
-    init_pair(L, COLOR_NEW_BLACK, COLOR_NEW_RED);
-    init_pair(L_R, COLOR_NEW_BLACK, COLOR_NEW_RED);
-    init_pair(N, COLOR_NEW_BLACK, COLOR_NEW_ORANGE);
-    init_pair(N_R, COLOR_NEW_BLACK, COLOR_NEW_ORANGE);
-    init_pair(P, COLOR_NEW_BLACK, COLOR_NEW_CYAN);
-    init_pair(P_R, COLOR_NEW_BLACK, COLOR_NEW_CYAN);
-    init_pair(T, COLOR_NEW_BLACK, COLOR_NEW_GREEN);
-    init_pair(U, COLOR_NEW_BLACK, COLOR_NEW_WHITE);
-    init_pair(W, COLOR_NEW_BLACK, COLOR_NEW_BROWN);
-    init_pair(Y, COLOR_NEW_BLACK, COLOR_NEW_YELLOW);
-    init_pair(Y_R, COLOR_NEW_BLACK, COLOR_NEW_YELLOW);
-    init_pair(I_SHORT, COLOR_NEW_BLACK, COLOR_NEW_PURPLE);
-    init_pair(GHOST, COLOR_NEW_WHITE, COLOR_NEW_DARK_PURPLE);
+static const Renderer *renderer = &NCURSES_RENDERER; /**< @brief Terminal backend. */
+
+// frame compositor
+static volatile sig_atomic_t frame_dirty; /**< @brief Set if some window has been updated since the last frame, by the timer too. */
+static struct timespec last_frame; /**< @brief Time of the last frame. */
+
+// terminal output accounting
+static bool output_accounting; /**< @brief True if the output of each frame is recorded in the probes. */
+static FrameOutput last_output; /**< @brief Output of the last frame. */
+static FrameOutput total_output; /**< @brief Output of all the frames. */
+static long frames; /**< @brief Number of frames. */
+static long input_time; /**< @brief Time the oldest key not yet on the screen was read, 0 if none. */
+static volatile sig_atomic_t wakeup_requested; /**< @brief Set by wake_up_gui(). */
+
+// debug overlay
+static bool overlay_visible;
+static bool overlay_dirty; /**< @brief True if the overlay has been updated or erased since the last frame. */
+static long overlay_time; /**< @brief Time of the last update of the overlay. */
+static long overlay_counts[PROBES]; /**< @brief Number of values of each probe at the last update. */
+static long overlay_sums[PROBES]; /**< @brief Sum of the values of each probe at the last update. */
+static long overlay_tick_micros; /**< @brief Mean tick time of the last interval with ticks. */
+static long overlay_draw_micros; /**< @brief Mean render time of the last interval with frames. */
+static char overlay_text[OVERLAYS][OVERLAY_LINES][OVERLAY_WIDTH - 1]; /**< @brief Text lines of the panels. */
+
+/**
+ * @brief Return nanoseconds elapsed since the last frame.
+ * @return elapsed nanoseconds.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long elapsed_since_last_frame() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - last_frame.tv_sec)*1000000000L + (now.tv_nsec - last_frame.tv_nsec);
+}
+
+void init_gui(int b) {
+    switch (b) {
+        case BACKEND_NCURSES:
+            renderer = &NCURSES_RENDERER;
+            break;
+        case BACKEND_ANSI:
+            renderer = &ANSI_RENDERER;
+            break;
+        case BACKEND_NULL:
+            renderer = &NULL_RENDERER;
+            break;
+    }
+    renderer->init();
+}
+
+void end_gui() {
+    renderer->end();
 }
 
 void init_windows() {
@@ -166,285 +121,78 @@ void init_windows() {
     rules_page_select = RULES_PAGE_1;
     game_menu_select = MENU_PLAY;
     game_over_select = GAME_OVER_RESTART;
-    global_color = GUI_COLOR_DEFAULT;
-
-    // reference position to center the interface: refer to curr_field_win (double horizontal characters)
-    int curr_x = (COLS - CURR_WIDTH) / 2;
-    int curr_y = (LINES - CURR_HEIGHT - HELP_HEIGHT) / 2;
-
-    global_win = newwin(GLOBAL_HEIGHT, GLOBAL_WIDTH, curr_y - 1, curr_x - NEXT_WIDTH - 1);
-
-    options_win = newwin(OPTIONS_HEIGHT, OPTIONS_WIDTH, (LINES - OPTIONS_HEIGHT) / 2, (COLS - OPTIONS_WIDTH) / 2);
-    
-    rules_win = newwin(RULES_HEIGHT, RULES_WIDTH, (LINES - RULES_HEIGHT) / 2, (COLS - RULES_WIDTH) / 2);
-
-    new_game_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + 10, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
-    
-    options_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + 10 + 1 + MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
-
-    rules_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + 10 + 2 + 2*MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
-   
-    quit_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + 10 + 3 + 3*MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
-
-    curr_field_win = newwin(CURR_HEIGHT, CURR_WIDTH, curr_y, curr_x);
-
-    next_field_win = newwin(NEXT_HEIGHT, NEXT_WIDTH, curr_y, curr_x - NEXT_WIDTH);
-
-    level_win = newwin(STATS_HEIGHT, STATS_WIDTH, curr_y, curr_x + CURR_WIDTH);
-
-    score_win = newwin(STATS_HEIGHT, STATS_WIDTH, curr_y + STATS_HEIGHT, curr_x + CURR_WIDTH);
-
-    rows_win = newwin(STATS_HEIGHT, STATS_WIDTH, curr_y + 2*STATS_HEIGHT, curr_x + CURR_WIDTH);
-
-    help_win = newwin(HELP_HEIGHT, HELP_WIDTH, curr_y + CURR_HEIGHT, curr_x - (HELP_WIDTH - CURR_WIDTH) / 2);
-
-    game_menu_win = newwin(GAME_MENU_HEIGHT, GAME_MENU_WIDTH, (LINES - GAME_MENU_HEIGHT) / 2, (COLS - GAME_MENU_WIDTH) / 2);
-  
-    game_over_win = newwin(GAME_OVER_HEIGHT, GAME_OVER_WIDTH, (LINES - GAME_OVER_HEIGHT) / 2, (COLS - GAME_OVER_WIDTH) / 2);
+    frame_dirty = 0;
+    renderer->init_windows();
 }
 
 void refresh_global_win() {
-    wbkgd(stdscr, COLOR_PAIR(global_color));
-    refresh();
-    wbkgd(global_win, COLOR_PAIR(global_color));
-    mvwprintw(global_win, 1, 6, TITLE);
-    box(global_win, 0, 0);
-    wrefresh(global_win);
+    long start = get_time_probe();
+    renderer->draw_global_win();
+    record_probe(PROBE_REFRESH_GLOBAL, start);
+    frame_dirty = 1;
 }
 
 void refresh_main_menu() {
-    wbkgd(new_game_button, COLOR_PAIR(global_color));
-    box(new_game_button, 0, 0);
-    if (main_menu_select == NEW_GAME) {
-        wattron(new_game_button, A_STANDOUT);
-    }
-    mvwprintw(new_game_button, 1, 5, "NEW GAME");
-    wattroff(new_game_button, A_STANDOUT);
-
-    wbkgd(options_button, COLOR_PAIR(global_color));
-    box(options_button, 0, 0);
-    if (main_menu_select == OPTIONS) {
-        wattron(options_button, A_STANDOUT);
-    }
-    mvwprintw(options_button, 1, 5, "OPTIONS");
-    wattroff(options_button, A_STANDOUT);
-   
-    wbkgd(rules_button, COLOR_PAIR(global_color));
-    box(rules_button, 0, 0);
-    if (main_menu_select == RULES) {
-        wattron(rules_button, A_STANDOUT);
-    }
-    mvwprintw(rules_button, 1, 6, "RULES");
-    wattroff(rules_button, A_STANDOUT);
-
-    wbkgd(quit_button, COLOR_PAIR(global_color));
-    box(quit_button, 0, 0);
-    if (main_menu_select == QUIT) {
-        wattron(quit_button, A_STANDOUT);
-    }
-    mvwprintw(quit_button, 1, 6, "EXIT");
-    wattroff(quit_button, A_STANDOUT);
-
-    wrefresh(new_game_button);
-    wrefresh(options_button);
-    wrefresh(rules_button);
-    wrefresh(quit_button);
+    long start = get_time_probe();
+    renderer->draw_main_menu(main_menu_select);
+    record_probe(PROBE_REFRESH_MAIN_MENU, start);
+    frame_dirty = 1;
 }
 
 void refresh_curr_field_win(Field *f) {
-    // background color
-    wbkgd(curr_field_win, COLOR_PAIR(global_color));
-    // border
-    box(curr_field_win, 0, 0);
-    int row, col;
-    int color;
-    for (row = 0; row < f->rows; row++) {
-        for (col = 0; col < f->cols; col++) {
-            color = f->grid[row][col];
-            wattrset(curr_field_win, COLOR_PAIR(color));
-            if (color != BG) {
-                mvwprintw(curr_field_win, row + 1, CHAR_PER_CELL*col + 1, "..");
-            }
-            else {
-                mvwprintw(curr_field_win, row + 1, CHAR_PER_CELL*col + 1, "  ");
-            }
-        }
-    }
-    wrefresh(curr_field_win);
+    long start = get_time_probe();
+    renderer->draw_curr_field(f);
+    record_probe(PROBE_REFRESH_CURR_FIELD, start);
+    frame_dirty = 1;
 }
 
 void refresh_next_field_win(Field *f) {
-    wbkgd(next_field_win, COLOR_PAIR(global_color));
-    box(next_field_win, 0, 0);
-    mvwprintw(next_field_win, 0, 4, "Next");
-    int row, col;
-    int color;
-    for (row = 0; row < f->rows; row++) {
-        for (col = 0; col < f->cols; col++) {
-            color = f->grid[row][col];
-            wattrset(next_field_win, COLOR_PAIR(color));
-            if (color != BG) {
-                mvwprintw(next_field_win, row + 1, CHAR_PER_CELL*col + 1, "..");
-            }
-            else {
-                mvwprintw(next_field_win, row + 1, CHAR_PER_CELL*col + 1, "  ");
-            }
-        }
-    }
-    wrefresh(next_field_win);
+    long start = get_time_probe();
+    renderer->draw_next_field(f);
+    record_probe(PROBE_REFRESH_NEXT_FIELD, start);
+    frame_dirty = 1;
 }
 
 void refresh_stats_win(int level, int score, int rows) {
-    wbkgd(level_win, COLOR_PAIR(global_color));
-    box(level_win, 0, 0);
-    mvwprintw(level_win, 0, 4, "Level");
-    mvwprintw(level_win, 1, 5, "%02d", level);
-
-    wbkgd(score_win, COLOR_PAIR(global_color));
-    box(score_win, 0, 0);
-    mvwprintw(score_win, 0, 4, "Score");
-    mvwprintw(score_win, 1, 4, "%05d", score);
-
-    wbkgd(rows_win, COLOR_PAIR(global_color));
-    box(rows_win, 0, 0);
-    mvwprintw(rows_win, 0, 4, "Rows");
-    mvwprintw(rows_win, 1, 5, "%03d", rows);
-
-    wrefresh(level_win);
-    wrefresh(score_win);
-    wrefresh(rows_win);
+    long start = get_time_probe();
+    renderer->draw_stats(level, score, rows);
+    record_probe(PROBE_REFRESH_STATS, start);
+    frame_dirty = 1;
 }
 
 void refresh_help_win() {
-    wbkgd(help_win, COLOR_PAIR(global_color));
-    box(help_win, 0, 0);
-    mvwprintw(help_win, 1, 3, "Press P to open the menu");
-
-    wrefresh(help_win);
+    long start = get_time_probe();
+    renderer->draw_help();
+    record_probe(PROBE_REFRESH_HELP, start);
+    frame_dirty = 1;
 }
 
 void refresh_options_win() {
-    wbkgd(options_win, COLOR_PAIR(global_color));
-    box(options_win, 0, 0 );
-
-    mvwprintw(options_win, 0, 9, "OPTIONS");
-    mvwprintw(options_win, 2, 2, "Ghost:");
-    mvwprintw(options_win, 4, 2, "Color:");
-
-    if (options_select == OPTION_GHOST) {
-        wattron(options_win, A_STANDOUT);
-    }
-    switch (ghost_select) {
-        case OPT_GHOST_ON:
-            mvwprintw(options_win, 2, 11, "<   On    >");
-            break;
-        case OPT_GHOST_OFF:
-            mvwprintw(options_win, 2, 11, "<   Off   >");
-            break;
-    }
-    wattroff(options_win, A_STANDOUT);
-    
-    if (options_select == OPTION_COLOR) {
-        wattron(options_win, A_STANDOUT);
-    }
-    switch (color_select) {
-        case OPT_COLOR_DEFAULT:
-            mvwprintw(options_win, 4, 11, "< Default >");
-            break;
-        case OPT_COLOR_BLUE:
-            mvwprintw(options_win, 4, 11, "<  Blue   >");
-            break;
-        case OPT_COLOR_BLACK:
-            mvwprintw(options_win, 4, 11, "<  Black  >");
-            break;
-    }
-    wattroff(options_win, A_STANDOUT);
-
-    if (options_select == OPTION_OK) {
-        wattron(options_win, A_STANDOUT);
-    }
-    mvwprintw(options_win, 6, 11, "OK");
-    wattroff(options_win, A_STANDOUT);
-
-    wrefresh(options_win);
+    long start = get_time_probe();
+    renderer->draw_options(options_select, ghost_select, color_select);
+    record_probe(PROBE_REFRESH_OPTIONS, start);
+    frame_dirty = 1;
 }
 
 void refresh_rules_win() {
-    // cancella il contenuto
-    werase(rules_win);
-    wbkgd(rules_win, COLOR_PAIR(global_color));
-    box(rules_win, 0, 0 );
-    mvwprintw(rules_win, 0, 22, "RULES");
-
-    if (rules_page_select == RULES_PAGE_1) {
-        mvwprintw(rules_win, 2, 2, "The goal of the game consists in positioning");
-        mvwprintw(rules_win, 4, 2, "each block without leaving holes. The complet-");
-        mvwprintw(rules_win, 6, 2, "ed rows are removed and the player gets points.");
-        mvwprintw(rules_win, 8, 2, "If multiple rows are completed simultaneously,");
-        mvwprintw(rules_win, 10, 2, "bonus points are obtained. By disabling the");
-        mvwprintw(rules_win, 12, 2, "option \'Ghost\', the points are doubled.");
-        wattron(rules_win, A_STANDOUT);
-        mvwprintw(rules_win, 14, 23, "Next");
-        wattroff(rules_win, A_STANDOUT);
-    }
-    else if (rules_page_select == RULES_PAGE_2) {
-        mvwprintw(rules_win, 2, 14, "P  open the menu");
-        mvwprintw(rules_win, 4, 5, "Left arrow  move block to the left");
-        mvwprintw(rules_win, 6, 4, "Right arrow  move block to the right");
-        mvwprintw(rules_win, 8, 7, "Up arrow  rotate block");
-        mvwprintw(rules_win, 10, 5, "Down arrow  move block down");
-        mvwprintw(rules_win, 12, 10, "Space  make the block fall fast");
-        wattron(rules_win, A_STANDOUT);
-        mvwprintw(rules_win, 14, 24, "OK");
-        wattroff(rules_win, A_STANDOUT);
-    }
-    wrefresh(rules_win);
+    long start = get_time_probe();
+    renderer->draw_rules(rules_page_select);
+    record_probe(PROBE_REFRESH_RULES, start);
+    frame_dirty = 1;
 }
 
 void refresh_game_menu() {
-    wbkgd(game_menu_win, COLOR_PAIR(global_color));
-    box(game_menu_win, 0, 0 );
-    mvwprintw(game_menu_win, 0, 5, "MENU");
-
-    if (game_menu_select == MENU_PLAY) {
-        wattron(game_menu_win, A_STANDOUT);
-    }
-    mvwprintw(game_menu_win, 1, 4, "Resume");
-    wattroff(game_menu_win, A_STANDOUT);
-            
-    if (game_menu_select == MENU_RESTART) {
-        wattron(game_menu_win, A_STANDOUT);
-    }
-    mvwprintw(game_menu_win, 2, 4, "Restart");
-    wattroff(game_menu_win, A_STANDOUT);
-
-    if (game_menu_select == MENU_BACK) {
-        wattron(game_menu_win, A_STANDOUT);
-    }
-    mvwprintw(game_menu_win, 3, 5, "Exit");
-    wattroff(game_menu_win, A_STANDOUT);      
-
-    wrefresh(game_menu_win);
+    long start = get_time_probe();
+    renderer->draw_game_menu(game_menu_select);
+    record_probe(PROBE_REFRESH_GAME_MENU, start);
+    frame_dirty = 1;
 }
 
 void refresh_game_over_win() {
-    wbkgd(game_over_win, COLOR_PAIR(global_color));
-    box(game_over_win, 0, 0 );
-    mvwprintw(game_over_win, 0, 3, "GAME OVER");
- 
-    if (game_over_select == GAME_OVER_RESTART) {
-        wattron(game_over_win, A_STANDOUT);
-    }
-    mvwprintw(game_over_win, 1, 4, "Restart");
-    wattroff(game_over_win, A_STANDOUT);
-
-    if (game_over_select == GAME_OVER_BACK) {
-        wattron(game_over_win, A_STANDOUT);
-    }
-    mvwprintw(game_over_win, 2, 5, "Exit");
-    wattroff(game_over_win, A_STANDOUT);
-
-    wrefresh(game_over_win);
+    long start = get_time_probe();
+    renderer->draw_game_over(game_over_select);
+    record_probe(PROBE_REFRESH_GAME_OVER, start);
+    frame_dirty = 1;
 }
 
 void reset_main_menu() {
@@ -553,20 +301,242 @@ int scroll_up_game_over_win() {
     return game_over_select;
 }
 
+/**
+ * @brief Format a line of the debug overlay: label on the left, value on the right.
+ *
+ * @param line text line.
+ * @param label label, at most 5 characters.
+ * @param value value, NO_VALUE if there are no samples.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void format_overlay_line(char *line, const char *label, long value) {
+    if (value == NO_VALUE) {
+        snprintf(line, OVERLAY_WIDTH - 1, "%-5s%5s", label, "-");
+    }
+    else {
+        snprintf(line, OVERLAY_WIDTH - 1, "%-5s%5ld", label, value);
+    }
+}
+
+/**
+ * @brief Update the text of the debug overlay with the measures since the last update.
+ *
+ * Only the totals of the probes are read, so that nothing is measured when the overlay is hidden.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void update_overlay() {
+    long now = get_time_probe();
+    long counts[PROBES], sums[PROBES];
+    int p;
+    for (p = 0; p < PROBES; p++) {
+        get_total_probe(p, &counts[p], &sums[p]);
+    }
+
+    // means over the interval since the last update
+    long frames_interval = counts[PROBE_PRESENT] - overlay_counts[PROBE_PRESENT];
+    long ticks_interval = counts[PROBE_TICK] - overlay_counts[PROBE_TICK];
+    long fps = (now > overlay_time) ? frames_interval*1000000000L / (now - overlay_time) : NO_VALUE;
+    // intervals without samples keep the previous mean: ticks can be slower than the updates
+    if (ticks_interval > 0) {
+        overlay_tick_micros = (sums[PROBE_TICK] - overlay_sums[PROBE_TICK]) / ticks_interval / 1000;
+    }
+    if (frames_interval > 0) {
+        // window updates and flush to the terminal
+        long nanos = sums[PROBE_PRESENT] - overlay_sums[PROBE_PRESENT];
+        for (p = PROBE_REFRESH_GLOBAL; p <= PROBE_REFRESH_GAME_OVER; p++) {
+            nanos += sums[p] - overlay_sums[p];
+        }
+        overlay_draw_micros = nanos / frames_interval / 1000;
+    }
+    // bytes typed but not read yet
+    int queue = 0;
+    if (ioctl(STDIN_FILENO, FIONREAD, &queue) == -1) {
+        queue = NO_VALUE;
+    }
+    long input_micros = counts[PROBE_INPUT_TO_SCREEN] > 0 ? get_percentile_probe(PROBE_INPUT_TO_SCREEN, 99) / 1000 : NO_VALUE;
+
+    char (*text)[OVERLAY_WIDTH - 1] = overlay_text[OVERLAY_PERF];
+    format_overlay_line(text[0], "fps", fps);
+    format_overlay_line(text[1], "tick", overlay_tick_micros);
+    format_overlay_line(text[2], "draw", overlay_draw_micros);
+    format_overlay_line(text[3], "queue", queue);
+    format_overlay_line(text[4], "p99", input_micros);
+    snprintf(text[5], OVERLAY_WIDTH - 1, "%10s", "");
+    snprintf(text[6], OVERLAY_WIDTH - 1, "%-10s", "times: us");
+    snprintf(text[7], OVERLAY_WIDTH - 1, "%-10s", "p99: input");
+
+    text = overlay_text[OVERLAY_OUTPUT];
+    snprintf(text[0], OVERLAY_WIDTH - 1, "%-10s", "last frame");
+    format_overlay_line(text[1], "cells", frames > 0 ? last_output.cells : NO_VALUE);
+    format_overlay_line(text[2], "bytes", frames > 0 ? last_output.bytes : NO_VALUE);
+    format_overlay_line(text[3], "write", frames > 0 ? last_output.flushes : NO_VALUE);
+    snprintf(text[4], OVERLAY_WIDTH - 1, "%-10s", "avg/frame");
+    format_overlay_line(text[5], "cells", frames > 0 ? total_output.cells / frames : NO_VALUE);
+    format_overlay_line(text[6], "bytes", frames > 0 ? total_output.bytes / frames : NO_VALUE);
+    format_overlay_line(text[7], "write", frames > 0 ? total_output.flushes / frames : NO_VALUE);
+
+    for (p = 0; p < PROBES; p++) {
+        overlay_counts[p] = counts[p];
+        overlay_sums[p] = sums[p];
+    }
+    overlay_time = now;
+    overlay_dirty = true;
+}
+
+/**
+ * @brief Draw the panels of the debug overlay.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_overlay() {
+    const char *lines[OVERLAY_LINES];
+    int o, i;
+    for (o = 0; o < OVERLAYS; o++) {
+        for (i = 0; i < OVERLAY_LINES; i++) {
+            lines[i] = overlay_text[o][i];
+        }
+        renderer->draw_overlay(o, OVERLAY_TITLES[o], lines, OVERLAY_LINES);
+    }
+}
+
+void enable_accounting_gui() {
+    output_accounting = true;
+}
+
+void toggle_overlay_gui() {
+    overlay_visible = !overlay_visible;
+    if (overlay_visible) {
+        // the first means are taken from now on
+        overlay_time = get_time_probe();
+        overlay_tick_micros = NO_VALUE;
+        overlay_draw_micros = NO_VALUE;
+        int p;
+        for (p = 0; p < PROBES; p++) {
+            get_total_probe(p, &overlay_counts[p], &overlay_sums[p]);
+        }
+        update_overlay();
+    }
+    else {
+        int o;
+        for (o = 0; o < OVERLAYS; o++) {
+            renderer->erase_overlay(o);
+        }
+    }
+    overlay_dirty = true;
+}
+
+bool present_frame() {
+    if ((!frame_dirty && !overlay_dirty) || elapsed_since_last_frame() < FRAME_INTERVAL_NANOS) {
+        return false;
+    }
+    // cleared first: a window updated by the timer from now on is shown by the next frame
+    bool dirty = frame_dirty;
+    frame_dirty = 0;
+    // the overlay stays on top of the windows updated since the last frame
+    if (overlay_visible) {
+        draw_overlay();
+    }
+    // single flush of all the windows updated since the last frame
+    long start = get_time_probe();
+    if (!dirty) {
+        // frames of the overlay alone are not measured
+        renderer->present(NULL);
+    }
+    else if (output_accounting || overlay_visible) {
+        renderer->present(&last_output);
+        record_probe(PROBE_PRESENT, start);
+        record_value_probe(PROBE_FRAME_CELLS, last_output.cells);
+        record_value_probe(PROBE_FRAME_BYTES, last_output.bytes);
+        record_value_probe(PROBE_FRAME_FLUSHES, last_output.flushes);
+        total_output.cells += last_output.cells;
+        total_output.bytes += last_output.bytes;
+        total_output.flushes += last_output.flushes;
+        frames++;
+    }
+    else {
+        renderer->present(NULL);
+        record_probe(PROBE_PRESENT, start);
+    }
+    if (dirty && input_time != 0) {
+        record_probe(PROBE_INPUT_TO_SCREEN, input_time);
+        input_time = 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &last_frame);
+    overlay_dirty = false;
+    return true;
+}
+
+int get_key() {
+    int ch;
+    int wait_millis;
+    // the last key did not change the screen
+    if (!frame_dirty) {
+        input_time = 0;
+    }
+    do {
+        if (overlay_visible && get_time_probe() - overlay_time >= OVERLAY_INTERVAL_NANOS) {
+            update_overlay();
+        }
+        present_frame();
+        if (wakeup_requested) {
+            wakeup_requested = 0;
+            return KEY_WAKEUP;
+        }
+        // if a frame is pending, wake up when the frame rate cap allows to show it; the wait is never
+        // indefinite, since a tick may make a frame pending or request a wake-up after the checks and
+        // before the wait
+        wait_millis = (frame_dirty || overlay_dirty) ? (FRAME_INTERVAL_NANOS - elapsed_since_last_frame()) / 1000000 + 1 : MAX_WAIT_MILLIS;
+        // wake up for the next update of the overlay
+        if (overlay_visible) {
+            int overlay_millis = (overlay_time + OVERLAY_INTERVAL_NANOS - get_time_probe()) / 1000000 + 1;
+            if (overlay_millis < wait_millis) {
+                wait_millis = overlay_millis;
+            }
+        }
+        // ERR on timeout or when interrupted by the timer
+        ch = renderer->get_key(wait_millis);
+        // a dump of the latency histograms may have been requested meanwhile
+        poll_probes();
+        if (ch == KEY_OVERLAY || ch == KEY_OVERLAY_UPPER) {
+            toggle_overlay_gui();
+            ch = ERR;
+        }
+    } while (ch == ERR);
+    if (ch == KEY_EOF) {
+        // scripted input is over
+        end_gui();
+        dump_probes();
+        exit(EXIT_SUCCESS);
+    }
+    // the latency is measured from the oldest key not yet on the screen
+    if (input_time == 0) {
+        input_time = get_time_probe();
+    }
+    return ch;
+}
+
+void wake_up_gui() {
+    wakeup_requested = 1;
+}
+
 void change_global_color(int color) {
     switch (color) {
         case OPT_COLOR_DEFAULT:
-            global_color = GUI_COLOR_DEFAULT;
-            // update ghost background color
-            init_pair(GHOST, COLOR_NEW_WHITE, COLOR_NEW_DARK_PURPLE);
+            renderer->change_global_color(GUI_COLOR_DEFAULT);
             break;
         case OPT_COLOR_BLUE:
-            global_color = GUI_COLOR_BLUE;
-            init_pair(GHOST, COLOR_NEW_WHITE, COLOR_NEW_BLUE);
+            renderer->change_global_color(GUI_COLOR_BLUE);
             break;
-         case OPT_COLOR_BLACK:
-            global_color = GUI_COLOR_BLACK;
-            init_pair(GHOST, COLOR_NEW_WHITE, COLOR_NEW_BLACK);
+        case OPT_COLOR_BLACK:
+            renderer->change_global_color(GUI_COLOR_BLACK);
             break;
     }
 }
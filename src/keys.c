@@ -0,0 +1,72 @@
+/**
+ * @file keys.c
+ * @brief Keyboard input read from the standard input, for the backends that do not use ncurses.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Utils
+ * @{
+ */
+#include <poll.h>
+#include <unistd.h>
+#include <ncurses.h>
+
+#include "shared.h"
+#include "renderer.h"
+
+
+// pending input
+static char in_buf[32];
+static int in_len;
+static int in_pos;
+
+int read_stdin_key(int timeout_millis) {
+    if (in_pos >= in_len) {
+        struct pollfd pfd;
+        pfd.fd = STDIN_FILENO;
+        pfd.events = POLLIN;
+        // timeout or interrupted by the timer
+        if (poll(&pfd, 1, timeout_millis) <= 0) {
+            return ERR;
+        }
+        ssize_t n = read(STDIN_FILENO, in_buf, sizeof(in_buf));
+        if (n == 0) {
+            return KEY_EOF;
+        }
+        if (n < 0) {
+            return ERR;
+        }
+        in_len = n;
+        in_pos = 0;
+    }
+
+    char ch = in_buf[in_pos++];
+    // arrow keys, in normal (ESC [) or application (ESC O) cursor mode
+    if (ch == '\033' && in_len - in_pos >= 2 && (in_buf[in_pos] == '[' || in_buf[in_pos] == 'O')) {
+        switch (in_buf[in_pos + 1]) {
+            case 'A':
+                in_pos += 2;
+                return KEY_UP;
+            case 'B':
+                in_pos += 2;
+                return KEY_DOWN;
+            case 'C':
+                in_pos += 2;
+                return KEY_RIGHT;
+            case 'D':
+                in_pos += 2;
+                return KEY_LEFT;
+        }
+    }
+    if (ch == '\r') {
+        return '\n';
+    }
+    return (unsigned char)ch;
+}
+/** \} */
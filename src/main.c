@@ -34,30 +34,30 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
-#include <math.h>
 #include <time.h>
+#include <signal.h>
+#include <unistd.h>
 #include <ncurses.h>
 
 #include "shared.h"
 #include "field.h"
 #include "block.h"
 #include "timer.h"
+#include "game.h"
+#include "state.h"
+#include "bot.h"
+#include "finesse.h"
+#include "probe.h"
 #include "gui.h"
 
 
 #define KEY_MENU 112 /**< @brief Key P. */
 #define KEY_RETURN '\n' /**< @brief Key Enter. */
 #define KEY_SPACE ' ' /**< @brief Key Space. */
-
-#define LEVEL_CAP 10 /**< @brief Max level. */
-#define ROWS_PER_LEVEL 5 /**< @brief Number of completed rows required to level up. */
-#define SCORE_PER_ROW 100 /**< @brief Score for single row completed. */
-#define BONUS_EXPONENT 2 /**< @brief Bonus for multiple rows completed. */
-#define BONUS_GHOST_OFF 2 /**< @brief Bonus for disabling 'Ghost' option. */
-
-#define INIT_VALUE_MILLIS 800 /**< @brief Initial block fall interval in milliseconds. */
-#define INTERVAL_REDUCTION_PER_LEVEL_MILLIS 50 /**< @brief Interval per level to subtract from the current one in milliseconds. */
+#define DEFAULT_BUDGET_PERCENT 50 /**< @brief Default share of the fall interval the autoplay bot thinks for per block. */
 
 /**
  * @enum game_status
@@ -73,310 +73,283 @@ enum game_status {
     GAME_OVER
 };
 
-// statistics
-static int level;
-static int rows;
-static int score;
-static int status;
+static int status; /**< @brief Game status (enum game_status). */
 
-// game areas
-static Field *curr_field;
-static Field *next_field;
+static Game *game; /**< @brief Running game. */
 
-// blocks
-static Block *curr_block;
-static Block *ghost_block;
-static Block *next_block;
+static Bot *bot; /**< @brief Bot of the autoplay mode. */
+static bool autoplay; /**< @brief The blocks are placed by the bot. */
+static int budget_percent; /**< @brief Share of the fall interval the bot thinks for per block, in percent. */
+
+static Finesse *finesse; /**< @brief Planner of the keys pressed by the bot, and of the shortest ones the keys of the player are compared with. */
+static GameState spawn_state; /**< @brief State when the falling block appeared. */
+static int keys_pressed; /**< @brief Number of game keys pressed by the player since the falling block appeared. */
+static GameState locked_state; /**< @brief State when the last block locked by the player appeared. */
+static int locked_rot; /**< @brief Rotation of the last block locked by the player. */
+static int locked_row; /**< @brief Rotation center row of the last block locked by the player. */
+static int locked_col; /**< @brief Rotation center column of the last block locked by the player. */
+static int locked_keys; /**< @brief Number of game keys pressed by the player for the last locked block. */
+static volatile sig_atomic_t locked_pending; /**< @brief Set by the timer when the last locked block waits for record_wasted_keys(); the timer does not write it meanwhile. */
+static volatile sig_atomic_t placement_pending; /**< @brief Set by the timer when a new block waits for the autoplay bot. */
 
 // options
 static int option_ghost;
 static int option_color;
 
 /**
- * @brief Create new block.
+ * @brief Press a game key for the bot of the autoplay mode, as the player does.
+ *
+ * @param key key (enum finesse_key).
  *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
- * @since 1.0
+ * @version 1.1
+ * @since 1.1
  */
-static void drop_block() {
-    // init ghost if the option is enabled
-    if (option_ghost == OPT_GHOST_ON) {
-        init_ghost_block(ghost_block, next_block->type, next_block->rot, -BLOCK_MAX_SIZE, COLUMNS / 2);
-        // move down to position the ghost
-        while (can_move_block(ghost_block, curr_field, DOWN)) {
-            move_block(ghost_block, curr_field, DOWN);
-        }
-        write_block(ghost_block, curr_field);                    
+static void press_key_autoplay(int key) {
+    switch (key) {
+        case FINESSE_ROTATE:
+            rotate_block_game(game);
+            break;
+        case FINESSE_LEFT:
+            move_block_game(game, LEFT);
+            break;
+        case FINESSE_RIGHT:
+            move_block_game(game, RIGHT);
+            break;
+        case FINESSE_DOWN:
+            move_block_game(game, DOWN);
+            break;
+        case FINESSE_DROP:
+            fall_block_game(game);
+            break;
     }
-    
-    // init current block
-    init_block(curr_block, next_block->type, next_block->rot, -BLOCK_MAX_SIZE, COLUMNS / 2);
-    // move down until the first cell of the block appears on the screen
-    while (get_limit_high_block(curr_block) < 0 && can_move_block(curr_block, curr_field, DOWN)) {
-        move_block(curr_block, curr_field, DOWN);
-    }
-    write_block(curr_block, curr_field);
-
-    // Init next block
-    init_block(next_block, rand() % I_SHORT + 1, rand() % 4, BLOCK_MAX_SIZE / 2, BLOCK_MAX_SIZE / 2);
-
-    clear_field(next_field);
-    write_block(next_block, next_field);
-
-    refresh_curr_field_win(curr_field);
-    refresh_next_field_win(next_field);
 }
 
 /**
- * @brief Function to handle the tick of the timer.
+ * @brief Place the falling block with the bot of the autoplay mode.
+ *
+ * The bot thinks for a share of the fall interval of the current level, so that the block is placed
+ * before the next tick, then presses the fewest game keys that bring the block to its placement.
  *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
- * @since 1.0
+ * @version 1.1
+ * @since 1.1
  */
-static void timer_handler() {
-    if (can_move_block(curr_block, curr_field, DOWN)) {
-        move_block(curr_block, curr_field, DOWN);
-        refresh_curr_field_win(curr_field);
+static void play_autoplay() {
+    long start = get_time_probe();
+    long budget = get_interval_game(game)*1000000L*budget_percent / 100;
+    Placement p = find_placement_timed_bot(bot, game, budget);
+    uint8_t keys[FINESSE_MAX_KEYS];
+    int count = find_placement_keys_finesse(finesse, &spawn_state, p, keys);
+    int i;
+    if (count < 0) {
+        place_block_game(game, p);
     }
-    else {
-        stop_timer();
-        // check if the whole block appears on the screen: if not it is game over
-        if (get_limit_low_block(curr_block) < 0) {
-            status = GAME_OVER;
-            reset_game_over_win();
-            refresh_game_over_win();
-            return;
-        }
-
-        // find completed rows to delete by checking the ones occupied by curr_block
-        int row_to_clear = find_row_field(curr_field, get_limit_low_block(curr_block), get_limit_high_block(curr_block));
-        // count rows completed simultaneously
-        int rows_count = 0;
-        while (row_to_clear != -1) {
-            clear_row_field(curr_field, row_to_clear);
-            rows++;
-            // level up
-            if (rows % ROWS_PER_LEVEL == 0 && level < LEVEL_CAP) {
-                level++;
-            }
-            rows_count++;
-            row_to_clear = find_row_field(curr_field, get_limit_low_block(curr_block), get_limit_high_block(curr_block));
-        }
-
-        // update score with bonus
-        int bonus = (option_ghost == OPT_GHOST_OFF) ? BONUS_GHOST_OFF : 1;
-        score += SCORE_PER_ROW*(int)pow(rows_count, BONUS_EXPONENT)*bonus;
-
-        refresh_stats_win(level, score, rows);
-
-        // drop new block
-        drop_block();
-        // restart timer
-        start_timer(INIT_VALUE_MILLIS - INTERVAL_REDUCTION_PER_LEVEL_MILLIS*(level - 1));
+    for (i = 0; i < count; i++) {
+        press_key_autoplay(keys[i]);
     }
+    refresh_curr_field_win(game->curr_field);
+    record_probe(PROBE_AUTOPLAY, start);
 }
 
 /**
- * @brief Init game.
+ * @brief Record the keys pressed by the player beyond the shortest sequence to the final position of the last locked block.
  *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
- * @since 1.0
+ * @version 1.1
+ * @since 1.1
  */
-static void init_game() {
-    level = 1;
-    rows = 0;
-    score = 0;
-
-    init_field(curr_field, ROWS, COLUMNS);
-    init_field(next_field, BLOCK_MAX_SIZE, BLOCK_MAX_SIZE);
-
-    init_block(next_block, rand() % I_SHORT + 1, rand() % 4, BLOCK_MAX_SIZE / 2, BLOCK_MAX_SIZE / 2);
-
-    drop_block();
+static void record_wasted_keys() {
+    int wasted = count_wasted_keys_finesse(finesse, &locked_state, locked_rot, locked_row, locked_col, locked_keys);
+    if (wasted >= 0) {
+        record_value_probe(PROBE_WASTED_KEYS, wasted);
+    }
+    locked_pending = 0;
+}
 
-    refresh_help_win();
-    refresh_curr_field_win(curr_field);
-    refresh_next_field_win(next_field);
-    refresh_stats_win(level, score, rows);
+/**
+ * @brief Keep the state of the block that has just appeared, to plan and count its keys.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void start_block() {
+    pack_state(&spawn_state, game);
+    keys_pressed = 0;
 }
 
 /**
- * @brief Update 'Ghost'.
+ * @brief Function to handle the tick of the timer.
  *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
+ * @version 1.1
  * @since 1.0
  */
-static void update_ghost() {
-    update_block(ghost_block, curr_field, curr_block->rot, curr_block->row, curr_block->col);
-    while (can_move_block(ghost_block, curr_field, DOWN)) {
-        move_block(ghost_block, curr_field, DOWN);
+static void timer_handler() {
+    long start = get_time_probe();
+    // the final position of the block, if the tick locks it
+    int rot = game->curr_block->rot;
+    int row = game->curr_block->row;
+    int col = game->curr_block->col;
+    int result = tick_game(game);
+    if (result == TICK_LOCKED) {
+        // the keys are counted by the game loop, out of the signal handler
+        if (!autoplay && !locked_pending) {
+            locked_state = spawn_state;
+            locked_rot = rot;
+            locked_row = row;
+            locked_col = col;
+            locked_keys = keys_pressed;
+            locked_pending = 1;
+            wake_up_gui();
+        }
+        start_block();
+    }
+    switch (result) {
+        case TICK_MOVED:
+            refresh_curr_field_win(game->curr_field);
+            break;
+        case TICK_LOCKED:
+            refresh_stats_win(game->level, game->score, game->rows);
+            refresh_curr_field_win(game->curr_field);
+            refresh_next_field_win(game->next_field);
+            // restart timer at the interval of the current level
+            stop_timer();
+            start_timer(get_interval_game(game));
+            break;
+        case TICK_GAME_OVER:
+            stop_timer();
+            status = GAME_OVER;
+            reset_game_over_win();
+            refresh_game_over_win();
+            break;
+    }
+    record_probe(PROBE_TICK, start);
+    // the new block is placed by the game loop, out of the signal handler, before the next tick
+    if (autoplay && result == TICK_LOCKED) {
+        placement_pending = 1;
+        wake_up_gui();
     }
-    // update curr_block to prevent the ghost from overwriting it in case of superposition
-    update_block(curr_block, curr_field, curr_block->rot, curr_block->row, curr_block->col);
 }
 
 /**
- * @brief Fix block position after failed rotation.
+ * @brief Start a new game and draw it.
  *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
+ * @version 1.1
  * @since 1.0
  */
-static void fix_block_position() {
-    // if possible, move left
-    if (can_move_block(curr_block, curr_field, LEFT)) {
-        move_block(curr_block, curr_field, LEFT);
-        // if possible, rotate
-        if (can_rotate_block(curr_block, curr_field)) {
-            rotate_block(curr_block, curr_field);
-        }
-        // if possible, move left again
-        else if (can_move_block(curr_block, curr_field, LEFT)) {
-            move_block(curr_block, curr_field, LEFT);
-            // if possible, rotate
-            if (can_rotate_block(curr_block, curr_field)) {
-                rotate_block(curr_block, curr_field);
-            }
-            // otherwise reset it to the initial position, by moving it twice to the right
-            else {
-                move_block(curr_block, curr_field, RIGHT);
-                move_block(curr_block, curr_field, RIGHT);
-            }
-        }
-        else {
-            // otherwise reset it to the initial position, by moving it once to the right
-            move_block(curr_block, curr_field, RIGHT); 
-        }
-    }
+static void new_game() {
+    init_game(game, option_ghost, rand());
 
-    // if possible, move right
-    if (can_move_block(curr_block, curr_field, RIGHT)) {
-        move_block(curr_block, curr_field, RIGHT);
-        // if possible, rotate
-        if (can_rotate_block(curr_block, curr_field)) {
-            rotate_block(curr_block, curr_field);
-        }
-        // if possible, move right again
-        else if (can_move_block(curr_block, curr_field, RIGHT)) {
-            move_block(curr_block, curr_field, RIGHT);
-            // if possible, rotate
-            if (can_rotate_block(curr_block, curr_field)) {
-                rotate_block(curr_block, curr_field);
-            }
-            // otherwise reset it to the initial position, by moving it twice to the left
-            else {
-                move_block(curr_block, curr_field, LEFT);
-                move_block(curr_block, curr_field, LEFT);
-            }
-        }
-        else {
-            // otherwise reset it to the initial position, by moving it once to the left
-            move_block(curr_block, curr_field, LEFT);
-            // the block cannot rotate, even after repositioning
-        }
+    refresh_help_win();
+    refresh_curr_field_win(game->curr_field);
+    refresh_next_field_win(game->next_field);
+    refresh_stats_win(game->level, game->score, game->rows);
+    start_block();
+    // a placement requested by the previous game is stale
+    placement_pending = 0;
+    // the timer starts after the first block is placed
+    if (autoplay) {
+        play_autoplay();
     }
 }
 
 /**
  * @brief Main game loop.
  *
+ * @param bot_plays true if the blocks are placed by the bot, false if they are moved by the player.
+ *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
+ * @version 1.1
  * @since 1.0
  */
-static void game_loop() {
-    curr_field = create_field();
-    next_field = create_field();
-
-    curr_block = create_block();
-    if (option_ghost == OPT_GHOST_ON) {
-        ghost_block = create_block();
+static void game_loop(bool bot_plays) {
+    // the game is allocated once, then reset in place at every new game
+    if (game == NULL) {
+        game = create_game();
+    }
+    autoplay = bot_plays;
+    if (autoplay && bot == NULL) {
+        // the falling block and the next one, as far as the time budget allows
+        bot = create_bot(&DEFAULT_WEIGHTS);
+        bot->depth = 2;
     }
-    next_block = create_block();
-    
+    if (finesse == NULL) {
+        finesse = create_finesse();
+    }
+
     // init random number generator
     srand(time(NULL));
 
-    init_game();
+    new_game();
 
     make_timer(timer_handler);
-    start_timer(INIT_VALUE_MILLIS);
+    start_timer(get_interval_game(game));
 
     // menu selectors
     int menu_selection = MENU_PLAY;
     int game_over_selection = GAME_OVER_RESTART;
     int ch;
     // input routine
-    while (ch = getch()) {
-        if (status == GAME_RUNNING) {
+    while (ch = get_key()) {
+        if (locked_pending) {
+            record_wasted_keys();
+        }
+        if (status == GAME_RUNNING && placement_pending) {
+            // the timer has just been restarted at the lock of the previous block
+            placement_pending = 0;
+            play_autoplay();
+        }
+        // in autoplay the bot moves the blocks, and only the menu key is read
+        if (status == GAME_RUNNING && (!autoplay || ch == KEY_MENU)) {
+            long start = get_time_probe();
             switch (ch) {
                 case KEY_UP:
-                    // rotate
-                    if (can_rotate_block(curr_block, curr_field)) {
-                        rotate_block(curr_block, curr_field);
-                        if (option_ghost == OPT_GHOST_ON) {
-                            update_ghost();
-                        }
-                        refresh_curr_field_win(curr_field);
-                    }
-                    else {
-                        // fix block position
-                        fix_block_position();
-                        if (option_ghost == OPT_GHOST_ON) {
-                            update_ghost();
-                        }
-                        refresh_curr_field_win(curr_field);
-                    }
+                    // rotate, or fix block position if it does not fit
+                    keys_pressed++;
+                    rotate_block_game(game);
+                    refresh_curr_field_win(game->curr_field);
+                    record_probe(PROBE_KEY_UP, start);
                     break;
                 case KEY_DOWN:
                     // move down
-                    if (can_move_block(curr_block, curr_field, DOWN)) {
-                        move_block(curr_block, curr_field, DOWN);
-                        if (option_ghost == OPT_GHOST_ON) {
-                            update_ghost();
-                        }
-                        refresh_curr_field_win(curr_field);
-                    }          
+                    keys_pressed++;
+                    if (move_block_game(game, DOWN)) {
+                        refresh_curr_field_win(game->curr_field);
+                    }
+                    record_probe(PROBE_KEY_DOWN, start);
                     break;
                 case KEY_LEFT:
                     // move left
-                    if (can_move_block(curr_block, curr_field, LEFT)) {
-                        move_block(curr_block, curr_field, LEFT);
-                        if (option_ghost == OPT_GHOST_ON) {
-                            update_ghost();
-                        }
-                        refresh_curr_field_win(curr_field);
+                    keys_pressed++;
+                    if (move_block_game(game, LEFT)) {
+                        refresh_curr_field_win(game->curr_field);
                     }
+                    record_probe(PROBE_KEY_LEFT, start);
                     break;
                 case KEY_RIGHT:
                     // move right
-                    if (can_move_block(curr_block, curr_field, RIGHT)) {
-                        move_block(curr_block, curr_field, RIGHT);
-                        if (option_ghost == OPT_GHOST_ON) {
-                            update_ghost();
-                        }
-                        refresh_curr_field_win(curr_field);
+                    keys_pressed++;
+                    if (move_block_game(game, RIGHT)) {
+                        refresh_curr_field_win(game->curr_field);
                     }
+                    record_probe(PROBE_KEY_RIGHT, start);
                     break;
                 case KEY_SPACE:
                     // fall instantaneously
-                    while (can_move_block(curr_block, curr_field, DOWN)) {
-                        move_block(curr_block, curr_field, DOWN);
-                    }
-                    if (option_ghost == OPT_GHOST_ON) {
-                        update_ghost();
-                    }
-                    refresh_curr_field_win(curr_field);
+                    keys_pressed++;
+                    fall_block_game(game);
+                    refresh_curr_field_win(game->curr_field);
+                    record_probe(PROBE_KEY_SPACE, start);
                     break;
                 case KEY_MENU:
                     // menu
                     stop_timer();
                     status = GAME_MENU;
                     refresh_game_menu();
+                    record_probe(PROBE_KEY_MENU, start);
             }
         }
         else if (status == GAME_MENU) {      
@@ -393,28 +366,21 @@ static void game_loop() {
                         switch (menu_selection) {
                             case MENU_PLAY:
                                 refresh_help_win();
-                                refresh_curr_field_win(curr_field);
-                                refresh_next_field_win(next_field);
-                                refresh_stats_win(level, score, rows);
+                                refresh_curr_field_win(game->curr_field);
+                                refresh_next_field_win(game->next_field);
+                                refresh_stats_win(game->level, game->score, game->rows);
                                 reset_game_menu();
                                 status = GAME_RUNNING;
-                                start_timer(INIT_VALUE_MILLIS - INTERVAL_REDUCTION_PER_LEVEL_MILLIS*(level - 1));
+                                start_timer(get_interval_game(game));
                                 break;
                             case MENU_RESTART:
-                                init_game();
+                                new_game();
                                 reset_game_menu();
                                 status = GAME_RUNNING;
-                                start_timer(INIT_VALUE_MILLIS);
+                                start_timer(get_interval_game(game));
                                 menu_selection = MENU_PLAY;
                                 break;
                             case MENU_BACK:
-                                delete_field(curr_field);
-                                delete_field(next_field);
-                                delete_block(curr_block);
-                                if (option_ghost == OPT_GHOST_ON) {
-                                    delete_block(ghost_block);
-                                }
-                                delete_block(next_block);
                                 delete_timer();
                                 reset_game_menu();
                                 refresh_global_win();
@@ -438,19 +404,12 @@ static void game_loop() {
                     switch (game_over_selection) {
                         case GAME_OVER_RESTART:
                             status = GAME_RUNNING;
-                            init_game();
+                            new_game();
                             reset_game_menu();
-                            start_timer(INIT_VALUE_MILLIS);
+                            start_timer(get_interval_game(game));
                             game_over_selection = GAME_OVER_RESTART;
                             break;
                         case GAME_OVER_BACK:
-                            delete_field(curr_field);
-                            delete_field(next_field);
-                            delete_block(curr_block);
-                            if (option_ghost == OPT_GHOST_ON) {
-                                delete_block(ghost_block);
-                            }
-                            delete_block(next_block);
                             delete_timer();
                             reset_game_menu();
                             refresh_global_win();
@@ -466,22 +425,54 @@ static void game_loop() {
 /**
  * @brief Game routine.
  *
+ * Usage: TetrisC [-r ncurses|ansi|null] [-s file] [-d] [-a percent], where -r selects the terminal backend (default ncurses),
+ * -s the file the latency histograms and the terminal output per frame are appended to, on exit and on SIGUSR1,
+ * -d shows the debug overlay from the start (the O key shows and hides it), and -a sets the share of the fall
+ * interval the bot of the autoplay mode thinks for per block (default 50).
+ *
+ * @param argc number of arguments.
+ * @param argv arguments.
+ *
  * @author Luca Della Libera (<luca310795@gmail.com>)
- * @version 1.0
+ * @version 1.1
  * @since 1.0
  */
-int main() {
-    // init window mode of ncurses
-    initscr();
-    // hide cursor
-    curs_set(0);
-    // prevent pressed keys from writing on the terminal
-    noecho();
-    init_colors();
-    // disable line buffering
-    cbreak();
-    // enable pressed keys acquisition
-    keypad(stdscr, TRUE);
+int main(int argc, char *argv[]) {
+    int backend = BACKEND_NCURSES;
+    const char *stats_path = NULL;
+    bool debug = false;
+    budget_percent = DEFAULT_BUDGET_PERCENT;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:s:da:")) != -1) {
+        if (opt == 'r' && strcmp(optarg, "ncurses") == 0) {
+            backend = BACKEND_NCURSES;
+        }
+        else if (opt == 'r' && strcmp(optarg, "ansi") == 0) {
+            backend = BACKEND_ANSI;
+        }
+        else if (opt == 'r' && strcmp(optarg, "null") == 0) {
+            backend = BACKEND_NULL;
+        }
+        else if (opt == 's') {
+            stats_path = optarg;
+        }
+        else if (opt == 'd') {
+            debug = true;
+        }
+        else if (opt == 'a' && atoi(optarg) > 0 && atoi(optarg) < 100) {
+            budget_percent = atoi(optarg);
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-r ncurses|ansi|null] [-s file] [-d] [-a percent]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    init_probes(stats_path);
+    init_gui(backend);
+    if (stats_path != NULL) {
+        enable_accounting_gui();
+    }
 
     // default options
     option_ghost = OPT_GHOST_ON;
@@ -490,13 +481,16 @@ int main() {
     init_windows();
     refresh_global_win();
     refresh_main_menu();
+    if (debug) {
+        toggle_overlay_gui();
+    }
 
     // init menu selectors
     int menu_selection = NEW_GAME;
     int options_selection = OPTION_GHOST;
     int ch;
     // input routine
-    while (ch = getch()) {
+    while (ch = get_key()) {
         switch (ch) {
             case KEY_UP:
                 menu_selection = scroll_up_main_menu();
@@ -511,11 +505,16 @@ int main() {
                     case NEW_GAME:
                         reset_main_menu();
                         status = GAME_RUNNING;
-                        game_loop();
+                        game_loop(false);
+                        break;
+                    case AUTOPLAY:
+                        reset_main_menu();
+                        status = GAME_RUNNING;
+                        game_loop(true);
                         break;
                     case OPTIONS:
                         refresh_options_win();
-                        while (ch = getch(), (ch != KEY_RETURN || options_selection != OPTION_OK)) {
+                        while (ch = get_key(), (ch != KEY_RETURN || options_selection != OPTION_OK)) {
                             switch (ch) {
                                 case KEY_UP:
                                     options_selection = scroll_up_options_win();
@@ -558,18 +557,27 @@ int main() {
                         break;
                     case RULES:
                         refresh_rules_win();
-                        while (ch = getch(), ch != KEY_RETURN);
+                        while (ch = get_key(), ch != KEY_RETURN);
                         scroll_down_rules_win();
                         refresh_rules_win();
-                        while (ch = getch(), ch != KEY_RETURN);
+                        while (ch = get_key(), ch != KEY_RETURN);
                         reset_rules_win();
                         refresh_global_win();
                         refresh_main_menu();
                         break;
                     case QUIT:
                         reset_main_menu();
-                        // terminate window mode of ncurses
-                        endwin();
+                        if (game != NULL) {
+                            delete_game(game);
+                        }
+                        if (bot != NULL) {
+                            delete_bot(bot);
+                        }
+                        if (finesse != NULL) {
+                            delete_finesse(finesse);
+                        }
+                        end_gui();
+                        dump_probes();
                         return EXIT_SUCCESS;
                         break;
                 }
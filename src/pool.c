@@ -0,0 +1,126 @@
+/**
+ * @file pool.c
+ * @brief Functions of a pool of threads that run the same task together, for the parallel searches.
+ *
+ * The threads are started once, with the pool, and wait on a barrier for each task; a second barrier
+ * waits for the end of the task on every thread. A task splits its work by the index of the thread,
+ * so nothing is allocated or locked while it runs.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Utils
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "shared.h"
+#include "pool.h"
+
+
+/**
+ * @struct Worker
+ * @brief Thread of a pool.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    Pool *pool; /**< @brief Pool. */
+    int id; /**< @brief Index of the thread. */
+    pthread_t thread; /**< @brief Thread. */
+} Worker;
+
+struct Pool {
+    int threads; /**< @brief Number of threads, the calling one included. */
+    void (*task)(void *arg, int id); /**< @brief Running task, NULL to stop the threads. */
+    void *arg; /**< @brief Argument of the running task. */
+    pthread_barrier_t start_barrier; /**< @brief Barrier to start a task. */
+    pthread_barrier_t end_barrier; /**< @brief Barrier to wait for the end of a task. */
+    Worker workers[POOL_MAX_THREADS]; /**< @brief Threads, the first one being the calling one. */
+};
+
+/**
+ * @brief Thread routine: run the tasks of the pool, until it is deleted.
+ *
+ * @param arg worker pointer.
+ * @return NULL.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void *worker_routine(void *arg) {
+    Worker *w = arg;
+    Pool *p = w->pool;
+    while (true) {
+        pthread_barrier_wait(&p->start_barrier);
+        if (p->task == NULL) {
+            break;
+        }
+        p->task(p->arg, w->id);
+        pthread_barrier_wait(&p->end_barrier);
+    }
+    return NULL;
+}
+
+Pool *create_pool(int threads) {
+    Pool *p = malloc(sizeof(Pool));
+    if (p == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    p->threads = threads < 1 ? 1 : (threads > POOL_MAX_THREADS ? POOL_MAX_THREADS : threads);
+    p->task = NULL;
+    p->arg = NULL;
+    pthread_barrier_init(&p->start_barrier, NULL, p->threads);
+    pthread_barrier_init(&p->end_barrier, NULL, p->threads);
+    int i;
+    for (i = 0; i < p->threads; i++) {
+        p->workers[i].pool = p;
+        p->workers[i].id = i;
+        if (i > 0 && pthread_create(&p->workers[i].thread, NULL, worker_routine, &p->workers[i]) != 0) {
+            ERROR_EXIT("pthread_create");
+        }
+    }
+    return p;
+}
+
+void delete_pool(Pool *p) {
+    int i;
+    if (p->threads > 1) {
+        p->task = NULL;
+        pthread_barrier_wait(&p->start_barrier);
+        for (i = 1; i < p->threads; i++) {
+            pthread_join(p->workers[i].thread, NULL);
+        }
+    }
+    pthread_barrier_destroy(&p->start_barrier);
+    pthread_barrier_destroy(&p->end_barrier);
+    free(p);
+}
+
+int get_threads_pool(Pool *p) {
+    return p->threads;
+}
+
+void run_pool(Pool *p, void (*task)(void *arg, int id), void *arg) {
+    if (p->threads == 1) {
+        task(arg, 0);
+        return;
+    }
+    p->task = task;
+    p->arg = arg;
+    pthread_barrier_wait(&p->start_barrier);
+    task(arg, 0);
+    pthread_barrier_wait(&p->end_barrier);
+}
+/** \} */
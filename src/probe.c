@@ -0,0 +1,317 @@
+/**
+ * @file probe.c
+ * @brief Latency histograms of the timer tick, the input handling and the rendering, and size histograms of the terminal output.
+ *
+ * Histograms are log-linear, as in HdrHistogram: each power of two is split into 16 buckets, so that
+ * every latency is recorded with a relative error below 1/16 in a fixed amount of memory. Each thread
+ * owns a set of histograms, updated with relaxed atomic increments only, so that recording never
+ * takes a lock and can be done in a signal handler (the timer tick). Sets are merged when read.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Utils
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <time.h>
+
+#include "shared.h"
+#include "probe.h"
+
+
+#define SUB_BITS 4 /**< @brief Number of bits of the bucket index inside a power of two. */
+#define SUB_BUCKETS (1 << SUB_BITS) /**< @brief Number of buckets per power of two. */
+#define MAX_EXPONENT 40 /**< @brief Largest power of two of a recorded latency (about 18 minutes). */
+#define BUCKETS ((MAX_EXPONENT - SUB_BITS + 2)*SUB_BUCKETS) /**< @brief Number of buckets of a histogram. */
+#define MAX_VALUE ((1L << (MAX_EXPONENT + 1)) - 1) /**< @brief Largest recorded latency, longer ones are clamped. */
+
+/**
+ * @struct ProbeSet
+ * @brief Histograms of all the probes of a thread.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct ProbeSet {
+    atomic_long counts[PROBES][BUCKETS]; /**< @brief Number of latencies per bucket. */
+    atomic_long max[PROBES]; /**< @brief Largest latency. */
+    atomic_long sum[PROBES]; /**< @brief Sum of the recorded values. */
+    struct ProbeSet *next; /**< @brief Set of another thread. */
+} ProbeSet;
+
+/**
+ * @brief Names of the probes, in the order of enum probe.
+ */
+static const char *PROBE_NAMES[PROBES] = {
+    "tick",
+    "key_up",
+    "key_down",
+    "key_left",
+    "key_right",
+    "key_space",
+    "key_menu",
+    "autoplay",
+    "refresh_global",
+    "refresh_main_menu",
+    "refresh_curr_field",
+    "refresh_next_field",
+    "refresh_stats",
+    "refresh_help",
+    "refresh_options",
+    "refresh_rules",
+    "refresh_game_menu",
+    "refresh_game_over",
+    "present",
+    "input_to_screen",
+    "frame_cells",
+    "frame_bytes",
+    "frame_flushes",
+    "wasted_keys"
+};
+
+static _Thread_local ProbeSet *local_set; /**< @brief Histograms of the calling thread. */
+static _Atomic(ProbeSet *) sets; /**< @brief Histograms of all the threads. */
+static const char *dump_path; /**< @brief File the histograms are appended to. */
+static volatile sig_atomic_t dump_requested; /**< @brief Set when SIGUSR1 is received. */
+
+/**
+ * @brief Return the bucket of a latency.
+ *
+ * @param nanos latency in nanoseconds.
+ * @return bucket index.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int get_bucket(long nanos) {
+    if (nanos < SUB_BUCKETS) {
+        return nanos < 0 ? 0 : nanos;
+    }
+    if (nanos > MAX_VALUE) {
+        nanos = MAX_VALUE;
+    }
+    int exponent = 63 - __builtin_clzl(nanos);
+    // the SUB_BITS bits after the leading one select the bucket inside the power of two
+    return (exponent - SUB_BITS + 1)*SUB_BUCKETS + ((nanos >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief Return the latency represented by a bucket: the middle of its range.
+ *
+ * @param bucket bucket index.
+ * @return latency in nanoseconds.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long get_bucket_value(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    long width = 1L << (exponent - SUB_BITS);
+    return (SUB_BUCKETS + bucket % SUB_BUCKETS)*width + width / 2;
+}
+
+/**
+ * @brief Return the histograms of the calling thread, allocating them at the first call.
+ *
+ * @return set pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static ProbeSet *get_local_set() {
+    if (local_set == NULL) {
+        local_set = calloc(1, sizeof(ProbeSet));
+        if (local_set == NULL) {
+            ERROR_EXIT("calloc");
+        }
+        // lock-free push on the list of the sets
+        local_set->next = atomic_load(&sets);
+        while (!atomic_compare_exchange_weak(&sets, &local_set->next, local_set)) {
+        }
+    }
+    return local_set;
+}
+
+/**
+ * @brief Function to handle SIGUSR1: the dump is done by poll_probes(), outside of the handler.
+ *
+ * @param sig signal number.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void request_dump(int sig) {
+    (void)sig;
+    dump_requested = 1;
+}
+
+void init_probes(const char *path) {
+    // allocate now, the first record of this thread may be done by a signal handler
+    get_local_set();
+    dump_path = path;
+    if (path == NULL) {
+        return;
+    }
+    struct sigaction s_action;
+    s_action.sa_handler = request_dump;
+    // blocking calls return, so that the request is polled soon
+    s_action.sa_flags = 0;
+    sigemptyset(&s_action.sa_mask);
+    if (sigaction(SIGUSR1, &s_action, NULL) == -1) {
+        ERROR_EXIT("sigaction");
+    }
+}
+
+long get_time_probe() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec*1000000000L + now.tv_nsec;
+}
+
+void record_probe(int probe, long start) {
+    record_value_probe(probe, get_time_probe() - start);
+}
+
+void record_value_probe(int probe, long value) {
+    ProbeSet *set = get_local_set();
+    atomic_fetch_add_explicit(&set->counts[probe][get_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&set->sum[probe], value, memory_order_relaxed);
+    long max = atomic_load_explicit(&set->max[probe], memory_order_relaxed);
+    // a signal handler of the same thread may record in between
+    while (value > max && !atomic_compare_exchange_weak_explicit(&set->max[probe], &max, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+long get_percentile_probe(int probe, double percentile) {
+    long counts[BUCKETS] = {0};
+    long total = 0;
+    ProbeSet *set;
+    int b;
+    for (set = atomic_load(&sets); set != NULL; set = set->next) {
+        for (b = 0; b < BUCKETS; b++) {
+            long count = atomic_load_explicit(&set->counts[probe][b], memory_order_relaxed);
+            counts[b] += count;
+            total += count;
+        }
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // rank of the percentile, at least the first latency
+    long rank = (long)(percentile / 100*total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    long seen = 0;
+    for (b = 0; b < BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= rank) {
+            return get_bucket_value(b);
+        }
+    }
+    return get_bucket_value(BUCKETS - 1);
+}
+
+void get_total_probe(int probe, long *count, long *sum) {
+    *count = 0;
+    *sum = 0;
+    ProbeSet *set;
+    int b;
+    for (set = atomic_load(&sets); set != NULL; set = set->next) {
+        for (b = 0; b < BUCKETS; b++) {
+            *count += atomic_load_explicit(&set->counts[probe][b], memory_order_relaxed);
+        }
+        *sum += atomic_load_explicit(&set->sum[probe], memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Print the percentiles of a probe, merged over all the threads.
+ *
+ * @param out output file.
+ * @param probe probe (enum probe).
+ * @param scale divisor of the printed values.
+ * @param with_sum true to also print the sum of the values.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void print_probe(FILE *out, int probe, double scale, bool with_sum) {
+    long count, sum, max = 0;
+    get_total_probe(probe, &count, &sum);
+    ProbeSet *set;
+    for (set = atomic_load(&sets); set != NULL; set = set->next) {
+        long set_max = atomic_load_explicit(&set->max[probe], memory_order_relaxed);
+        if (set_max > max) {
+            max = set_max;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+    fprintf(out, "%-20s %10ld", PROBE_NAMES[probe], count);
+    double percentiles[] = {50, 90, 99, 99.9};
+    int i;
+    for (i = 0; i < 4; i++) {
+        long value = get_percentile_probe(probe, percentiles[i]);
+        // the middle of the last bucket may exceed the largest value
+        fprintf(out, " %10.1f", (value < max ? value : max) / scale);
+    }
+    fprintf(out, " %10.1f", max / scale);
+    if (with_sum) {
+        fprintf(out, " %10ld", sum);
+    }
+    fprintf(out, "\n");
+}
+
+void dump_probes() {
+    if (dump_path == NULL) {
+        return;
+    }
+    FILE *out = fopen(dump_path, "a");
+    if (out == NULL) {
+        return;
+    }
+    int p;
+    fprintf(out, "%-20s %10s %10s %10s %10s %10s %10s (microseconds)\n", "probe", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (p = 0; p < PROBE_FRAME_CELLS; p++) {
+        print_probe(out, p, 1e3, false);
+    }
+    fprintf(out, "%-20s %10s %10s %10s %10s %10s %10s %10s\n", "output", "frames", "p50", "p90", "p99", "p99.9", "max", "total");
+    for (p = PROBE_FRAME_CELLS; p < PROBE_WASTED_KEYS; p++) {
+        print_probe(out, p, 1, true);
+    }
+    fprintf(out, "%-20s %10s %10s %10s %10s %10s %10s %10s\n", "input", "blocks", "p50", "p90", "p99", "p99.9", "max", "total");
+    for (p = PROBE_WASTED_KEYS; p < PROBES; p++) {
+        print_probe(out, p, 1, true);
+    }
+    fprintf(out, "\n");
+    fclose(out);
+}
+
+void poll_probes() {
+    if (dump_requested) {
+        dump_requested = 0;
+        dump_probes();
+    }
+}
+/** \} */
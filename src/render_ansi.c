@@ -0,0 +1,957 @@
+/**
+ * @file render_ansi.c
+ * @brief Terminal backend based on raw ANSI escape sequences.
+ *
+ * Each frame is composed in a cell buffer, and only the cells that differ from
+ * the previous frame are sent to the terminal with a single write().
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Utils
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <ncurses.h>
+
+#include "shared.h"
+#include "layout.h"
+#include "renderer.h"
+
+
+#define ATTR_PAIR 0x1F /**< @brief Mask of the color pair of a cell attribute. */
+#define ATTR_STANDOUT 0x20 /**< @brief Cell attribute flag: reverse video. */
+#define ATTR_ACS 0x40 /**< @brief Cell attribute flag: line drawing character. */
+#define ATTR_INVALID 0xFF /**< @brief Attribute of a cell of the front buffer that must be redrawn. */
+
+#define COLOR_DEFAULT -1 /**< @brief Default terminal color. */
+#define UNKNOWN -1 /**< @brief Unknown cursor coordinate. */
+#define MAX_SKIP_REWRITE 4 /**< @brief Max number of unchanged cells rewritten instead of moving the cursor. */
+#define MAX_BYTES_PER_CELL 64 /**< @brief Max number of bytes emitted for a cell: cursor move, SGR, charset switch and character. */
+
+#define DEFAULT_LINES 24 /**< @brief Number of lines if the terminal size is unknown. */
+#define DEFAULT_COLS 80 /**< @brief Number of columns if the terminal size is unknown. */
+
+/**
+ * @struct Cell
+ * @brief Character cell of the screen.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    char ch; /**< @brief Character (DEC line drawing character if ATTR_ACS is set). */
+    unsigned char attr; /**< @brief Color pair and attribute flags. */
+} Cell;
+
+/**
+ * @struct Rect
+ * @brief Screen area of a window.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int y; /**< @brief Top row. */
+    int x; /**< @brief Left column. */
+    int height; /**< @brief Number of rows. */
+    int width; /**< @brief Number of columns. */
+} Rect;
+
+static struct termios saved_termios; /**< @brief Terminal settings to restore on exit. */
+
+// screen
+static int lines;
+static int cols;
+static Cell *front; /**< @brief Cells on the terminal. */
+static Cell *back; /**< @brief Cells of the frame being composed. */
+static char *out; /**< @brief Bytes of the frame to send. */
+static size_t out_len;
+
+// terminal state
+static int cursor_y;
+static int cursor_x;
+static int sgr_fg;
+static int sgr_bg;
+static bool sgr_standout;
+static bool acs_on;
+
+// colors
+static int global_color;
+static int ghost_bg;
+
+// menu windows
+static Rect global_win;
+static Rect options_win;
+static Rect rules_win;
+static Rect new_game_button;
+static Rect autoplay_button;
+static Rect options_button;
+static Rect rules_button;
+static Rect quit_button;
+
+// game windows
+static Rect curr_field_win;
+static Rect next_field_win;
+static Rect level_win;
+static Rect score_win;
+static Rect rows_win;
+static Rect help_win;
+static Rect game_menu_win;
+static Rect game_over_win;
+static Rect overlay_wins[OVERLAYS];
+
+/**
+ * @brief Init window area, with the same argument order as newwin().
+ *
+ * @param r window area.
+ * @param height number of rows.
+ * @param width number of columns.
+ * @param y top row.
+ * @param x left column.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_rect(Rect *r, int height, int width, int y, int x) {
+    r->y = y;
+    r->x = x;
+    r->height = height;
+    r->width = width;
+}
+
+/**
+ * @brief Write cell of the frame being composed.
+ *
+ * @param y row.
+ * @param x column.
+ * @param ch character.
+ * @param attr attribute.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void put_cell(int y, int x, char ch, int attr) {
+    if (y >= 0 && y < lines && x >= 0 && x < cols) {
+        back[y*cols + x].ch = ch;
+        back[y*cols + x].attr = attr;
+    }
+}
+
+/**
+ * @brief Fill window with blanks (equivalent to wbkgd() on a new window).
+ *
+ * @param w window area.
+ * @param pair color pair.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void fill_win(Rect *w, int pair) {
+    int y, x;
+    for (y = 0; y < w->height; y++) {
+        for (x = 0; x < w->width; x++) {
+            put_cell(w->y + y, w->x + x, ' ', pair);
+        }
+    }
+}
+
+/**
+ * @brief Draw window border (equivalent to box()).
+ *
+ * @param w window area.
+ * @param pair color pair.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void box_win(Rect *w, int pair) {
+    int top = w->y;
+    int bottom = w->y + w->height - 1;
+    int left = w->x;
+    int right = w->x + w->width - 1;
+    int i;
+    for (i = left + 1; i < right; i++) {
+        put_cell(top, i, 'q', pair | ATTR_ACS);
+        put_cell(bottom, i, 'q', pair | ATTR_ACS);
+    }
+    for (i = top + 1; i < bottom; i++) {
+        put_cell(i, left, 'x', pair | ATTR_ACS);
+        put_cell(i, right, 'x', pair | ATTR_ACS);
+    }
+    put_cell(top, left, 'l', pair | ATTR_ACS);
+    put_cell(top, right, 'k', pair | ATTR_ACS);
+    put_cell(bottom, left, 'm', pair | ATTR_ACS);
+    put_cell(bottom, right, 'j', pair | ATTR_ACS);
+}
+
+/**
+ * @brief Print formatted text in a window (equivalent to mvwprintw()).
+ * A newline moves to the first column of the next row.
+ *
+ * @param w window area.
+ * @param y row relative to the window.
+ * @param x column relative to the window.
+ * @param attr attribute.
+ * @param fmt format string.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void print_win(Rect *w, int y, int x, int attr, const char *fmt, ...) {
+    char text[512];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    char *p;
+    for (p = text; *p != '\0'; p++) {
+        if (*p == '\n') {
+            y++;
+            x = 0;
+            continue;
+        }
+        if (y < w->height && x < w->width) {
+            put_cell(w->y + y, w->x + x, *p, attr);
+        }
+        x++;
+    }
+}
+
+/**
+ * @brief Draw the cells of a game area inside a window border.
+ *
+ * @param w window area.
+ * @param f field pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_field(Rect *w, Field *f) {
+    int row, col, i;
+    int color;
+    for (row = 0; row < f->rows; row++) {
+        for (col = 0; col < f->cols; col++) {
+            color = f->grid[row][col];
+            for (i = 0; i < CHAR_PER_CELL; i++) {
+                put_cell(w->y + row + 1, w->x + CHAR_PER_CELL*col + 1 + i, (color != BG) ? '.' : ' ', color);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Append bytes to the frame to send.
+ *
+ * @param s bytes.
+ * @param n number of bytes.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void emit(const char *s, int n) {
+    memcpy(out + out_len, s, n);
+    out_len += n;
+}
+
+/**
+ * @brief Append decimal number to the frame to send.
+ *
+ * @param n non-negative number.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void emit_int(int n) {
+    char digits[12];
+    int len = 0;
+    do {
+        digits[len++] = '0' + n % 10;
+        n /= 10;
+    } while (n > 0);
+    while (len > 0) {
+        out[out_len++] = digits[--len];
+    }
+}
+
+/**
+ * @brief Return number of decimal digits.
+ *
+ * @param n non-negative number.
+ * @return number of digits.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int count_digits(int n) {
+    int len = 1;
+    while (n >= 10) {
+        n /= 10;
+        len++;
+    }
+    return len;
+}
+
+/**
+ * @brief Append SGR parameters of a foreground or background color.
+ *
+ * @param color color (enum color or COLOR_DEFAULT).
+ * @param background true for background, false for foreground.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void emit_color(int color, bool background) {
+    if (color == COLOR_DEFAULT) {
+        emit(background ? "49" : "39", 2);
+        return;
+    }
+    int i;
+    emit(background ? "48;2" : "38;2", 4);
+    for (i = 0; i < 3; i++) {
+        out[out_len++] = ';';
+        // RGB components scaled from [0, 1000] to [0, 255]
+        emit_int(COLOR_RGB[color - COLOR_NEW_BLACK][i]*255/1000);
+    }
+}
+
+/**
+ * @brief Return foreground color of a color pair.
+ *
+ * @param pair color pair.
+ * @return color (enum color), COLOR_DEFAULT for pair 0 as in ncurses.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int pair_fg(int pair) {
+    return (pair == BG) ? COLOR_DEFAULT : PAIR_COLORS[pair][0];
+}
+
+/**
+ * @brief Return background color of a color pair.
+ *
+ * @param pair color pair.
+ * @return color (enum color), COLOR_DEFAULT for pair 0 as in ncurses.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int pair_bg(int pair) {
+    if (pair == BG) {
+        return COLOR_DEFAULT;
+    }
+    return (pair == GHOST) ? ghost_bg : PAIR_COLORS[pair][1];
+}
+
+/**
+ * @brief Append the sequences to switch the terminal to a cell attribute, if it is not already set.
+ *
+ * @param attr attribute.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void set_attr(int attr) {
+    int fg = pair_fg(attr & ATTR_PAIR);
+    int bg = pair_bg(attr & ATTR_PAIR);
+    bool standout = (attr & ATTR_STANDOUT) != 0;
+    bool acs = (attr & ATTR_ACS) != 0;
+
+    // only the changed SGR parameters are sent
+    if (fg != sgr_fg || bg != sgr_bg || standout != sgr_standout) {
+        bool first = true;
+        emit("\033[", 2);
+        if (standout != sgr_standout) {
+            emit(standout ? "7" : "27", standout ? 1 : 2);
+            first = false;
+        }
+        if (fg != sgr_fg) {
+            if (!first) {
+                out[out_len++] = ';';
+            }
+            emit_color(fg, false);
+            first = false;
+        }
+        if (bg != sgr_bg) {
+            if (!first) {
+                out[out_len++] = ';';
+            }
+            emit_color(bg, true);
+        }
+        out[out_len++] = 'm';
+        sgr_fg = fg;
+        sgr_bg = bg;
+        sgr_standout = standout;
+    }
+    if (acs != acs_on) {
+        emit(acs ? "\033(0" : "\033(B", 3);
+        acs_on = acs;
+    }
+}
+
+/**
+ * @brief Append the shortest sequence to move the cursor.
+ *
+ * @param y target row.
+ * @param x target column.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void move_cursor(int y, int x) {
+    if (cursor_y == y && cursor_x == x) {
+        return;
+    }
+    if (cursor_y == y && x > cursor_x) {
+        int gap = x - cursor_x;
+        // rewrite a few unchanged cells if they share the current attribute
+        if (gap <= MAX_SKIP_REWRITE) {
+            int i;
+            Cell *c = &front[y*cols + cursor_x];
+            for (i = 0; i < gap && c[i].attr != ATTR_INVALID; i++) {
+                if (pair_fg(c[i].attr & ATTR_PAIR) != sgr_fg || pair_bg(c[i].attr & ATTR_PAIR) != sgr_bg
+                    || ((c[i].attr & ATTR_STANDOUT) != 0) != sgr_standout || ((c[i].attr & ATTR_ACS) != 0) != acs_on) {
+                    break;
+                }
+            }
+            if (i == gap) {
+                for (i = 0; i < gap; i++) {
+                    out[out_len++] = c[i].ch;
+                }
+                cursor_x = x;
+                return;
+            }
+        }
+        // cursor forward, if shorter than an absolute position
+        if (3 + count_digits(gap) < 4 + count_digits(y + 1) + count_digits(x + 1)) {
+            emit("\033[", 2);
+            emit_int(gap);
+            out[out_len++] = 'C';
+            cursor_x = x;
+            return;
+        }
+    }
+    emit("\033[", 2);
+    emit_int(y + 1);
+    out[out_len++] = ';';
+    emit_int(x + 1);
+    out[out_len++] = 'H';
+    cursor_y = y;
+    cursor_x = x;
+}
+
+/**
+ * @brief Write the whole buffer to the terminal.
+ *
+ * @param buf bytes.
+ * @param len number of bytes.
+ * @return number of write() system calls.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int write_all(const char *buf, size_t len) {
+    int calls = 0;
+    while (len > 0) {
+        calls++;
+        ssize_t n = write(STDOUT_FILENO, buf, len);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ERROR_EXIT("write");
+        }
+        buf += n;
+        len -= n;
+    }
+    return calls;
+}
+
+/**
+ * @brief Init terminal: disable line buffering and echo, switch to the alternate screen and allocate the frame buffers.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init() {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        lines = ws.ws_row;
+        cols = ws.ws_col;
+    }
+    else {
+        lines = DEFAULT_LINES;
+        cols = DEFAULT_COLS;
+    }
+
+    // disable line buffering and echo
+    if (tcgetattr(STDIN_FILENO, &saved_termios) == -1) {
+        ERROR_EXIT("tcgetattr");
+    }
+    struct termios raw = saved_termios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == -1) {
+        ERROR_EXIT("tcsetattr");
+    }
+
+    // preallocate the frame buffers once
+    front = malloc(lines*cols*sizeof(Cell));
+    back = malloc(lines*cols*sizeof(Cell));
+    out = malloc(lines*cols*MAX_BYTES_PER_CELL);
+    if (front == NULL || back == NULL || out == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    int i;
+    // the cleared screen is made of blanks of the default pair
+    for (i = 0; i < lines*cols; i++) {
+        front[i].ch = ' ';
+        front[i].attr = BG;
+        back[i] = front[i];
+    }
+
+    global_color = GUI_COLOR_DEFAULT;
+    ghost_bg = PAIR_COLORS[GHOST][1];
+
+    // alternate screen, hidden cursor, default attributes, cleared screen
+    const char *setup = "\033[?1049h\033[?25l\033[0m\033(B\033[2J";
+    write_all(setup, strlen(setup));
+    cursor_y = UNKNOWN;
+    cursor_x = UNKNOWN;
+    sgr_fg = COLOR_DEFAULT;
+    sgr_bg = COLOR_DEFAULT;
+    sgr_standout = false;
+    acs_on = false;
+}
+
+/**
+ * @brief Restore terminal.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void end() {
+    // default attributes, visible cursor, main screen
+    const char *restore = "\033[0m\033(B\033[?25h\033[?1049l";
+    write_all(restore, strlen(restore));
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_termios);
+    free(front);
+    free(back);
+    free(out);
+}
+
+/**
+ * @brief Init window areas.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_windows() {
+    // same layout as the ncurses windows
+    int curr_x = (cols - CURR_WIDTH) / 2;
+    int curr_y = (lines - CURR_HEIGHT - HELP_HEIGHT) / 2;
+    init_rect(&global_win, GLOBAL_HEIGHT, GLOBAL_WIDTH, curr_y - 1, curr_x - NEXT_WIDTH - 1);
+    init_rect(&options_win, OPTIONS_HEIGHT, OPTIONS_WIDTH, (lines - OPTIONS_HEIGHT) / 2, (cols - OPTIONS_WIDTH) / 2);
+    init_rect(&rules_win, RULES_HEIGHT, RULES_WIDTH, (lines - RULES_HEIGHT) / 2, (cols - RULES_WIDTH) / 2);
+    init_rect(&new_game_button, MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+    init_rect(&autoplay_button, MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP + 1 + MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+    init_rect(&options_button, MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP + 2 + 2*MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+    init_rect(&rules_button, MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP + 3 + 3*MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+    init_rect(&quit_button, MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP + 4 + 4*MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+    init_rect(&curr_field_win, CURR_HEIGHT, CURR_WIDTH, curr_y, curr_x);
+    init_rect(&next_field_win, NEXT_HEIGHT, NEXT_WIDTH, curr_y, curr_x - NEXT_WIDTH);
+    init_rect(&level_win, STATS_HEIGHT, STATS_WIDTH, curr_y, curr_x + CURR_WIDTH);
+    init_rect(&score_win, STATS_HEIGHT, STATS_WIDTH, curr_y + STATS_HEIGHT, curr_x + CURR_WIDTH);
+    init_rect(&rows_win, STATS_HEIGHT, STATS_WIDTH, curr_y + 2*STATS_HEIGHT, curr_x + CURR_WIDTH);
+    init_rect(&help_win, HELP_HEIGHT, HELP_WIDTH, curr_y + CURR_HEIGHT, curr_x - (HELP_WIDTH - CURR_WIDTH) / 2);
+    init_rect(&game_menu_win, GAME_MENU_HEIGHT, GAME_MENU_WIDTH, (lines - GAME_MENU_HEIGHT) / 2, (cols - GAME_MENU_WIDTH) / 2);
+    init_rect(&game_over_win, GAME_OVER_HEIGHT, GAME_OVER_WIDTH, (lines - GAME_OVER_HEIGHT) / 2, (cols - GAME_OVER_WIDTH) / 2);
+    init_rect(&overlay_wins[OVERLAY_PERF], OVERLAY_HEIGHT, OVERLAY_WIDTH, curr_y + CURR_HEIGHT - OVERLAY_HEIGHT, curr_x - NEXT_WIDTH);
+    init_rect(&overlay_wins[OVERLAY_OUTPUT], OVERLAY_HEIGHT, OVERLAY_WIDTH, curr_y + CURR_HEIGHT - OVERLAY_HEIGHT, curr_x + CURR_WIDTH);
+}
+
+/**
+ * @brief Send the cells changed since the last frame to the terminal with a single write().
+ *
+ * @param output output of the frame, set if not NULL.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void present(FrameOutput *output) {
+    long cells = 0;
+    int calls = 0;
+    out_len = 0;
+    int y, x;
+    for (y = 0; y < lines; y++) {
+        for (x = 0; x < cols; x++) {
+            Cell *b = &back[y*cols + x];
+            Cell *f = &front[y*cols + x];
+            if (b->ch == f->ch && b->attr == f->attr) {
+                continue;
+            }
+            move_cursor(y, x);
+            set_attr(b->attr);
+            out[out_len++] = b->ch;
+            *f = *b;
+            cells++;
+            cursor_x++;
+            // the cursor position after writing the last column depends on the terminal
+            if (cursor_x >= cols) {
+                cursor_y = UNKNOWN;
+            }
+        }
+    }
+    if (out_len > 0) {
+        calls = write_all(out, out_len);
+    }
+    if (output != NULL) {
+        output->cells = cells;
+        output->bytes = out_len;
+        output->flushes = calls;
+    }
+}
+
+/**
+ * @brief Change GUI global color.
+ *
+ * @param color global GUI color (enum gui_color).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void change_global_color(int color) {
+    global_color = color;
+    ghost_bg = PAIR_COLORS[color][1];
+    // ghost cells on the terminal must be redrawn with the new background
+    int i;
+    for (i = 0; i < lines*cols; i++) {
+        if ((front[i].attr & ATTR_PAIR) == GHOST) {
+            front[i].attr = ATTR_INVALID;
+        }
+    }
+}
+
+/**
+ * @brief Draw global window.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_global_win() {
+    Rect screen;
+    init_rect(&screen, lines, cols, 0, 0);
+    fill_win(&screen, global_color);
+    print_win(&global_win, 1, 6, global_color, TITLE);
+    box_win(&global_win, global_color);
+}
+
+/**
+ * @brief Draw main menu.
+ *
+ * @param select selected element (enum main_menu).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_main_menu(int select) {
+    fill_win(&new_game_button, global_color);
+    box_win(&new_game_button, global_color);
+    print_win(&new_game_button, 1, 5, global_color | ((select == NEW_GAME) ? ATTR_STANDOUT : 0), "NEW GAME");
+
+    fill_win(&autoplay_button, global_color);
+    box_win(&autoplay_button, global_color);
+    print_win(&autoplay_button, 1, 5, global_color | ((select == AUTOPLAY) ? ATTR_STANDOUT : 0), "AUTOPLAY");
+
+    fill_win(&options_button, global_color);
+    box_win(&options_button, global_color);
+    print_win(&options_button, 1, 5, global_color | ((select == OPTIONS) ? ATTR_STANDOUT : 0), "OPTIONS");
+
+    fill_win(&rules_button, global_color);
+    box_win(&rules_button, global_color);
+    print_win(&rules_button, 1, 6, global_color | ((select == RULES) ? ATTR_STANDOUT : 0), "RULES");
+
+    fill_win(&quit_button, global_color);
+    box_win(&quit_button, global_color);
+    print_win(&quit_button, 1, 6, global_color | ((select == QUIT) ? ATTR_STANDOUT : 0), "EXIT");
+}
+
+/**
+ * @brief Draw main game area.
+ *
+ * @param f field pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_curr_field(Field *f) {
+    box_win(&curr_field_win, global_color);
+    draw_field(&curr_field_win, f);
+}
+
+/**
+ * @brief Draw next-block area.
+ *
+ * @param f field pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_next_field(Field *f) {
+    box_win(&next_field_win, global_color);
+    print_win(&next_field_win, 0, 4, global_color, "Next");
+    draw_field(&next_field_win, f);
+}
+
+/**
+ * @brief Draw game statistics.
+ *
+ * @param level level.
+ * @param score score.
+ * @param rows number of total deleted rows.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_stats(int level, int score, int rows) {
+    fill_win(&level_win, global_color);
+    box_win(&level_win, global_color);
+    print_win(&level_win, 0, 4, global_color, "Level");
+    print_win(&level_win, 1, 5, global_color, "%02d", level);
+
+    fill_win(&score_win, global_color);
+    box_win(&score_win, global_color);
+    print_win(&score_win, 0, 4, global_color, "Score");
+    print_win(&score_win, 1, 4, global_color, "%05d", score);
+
+    fill_win(&rows_win, global_color);
+    box_win(&rows_win, global_color);
+    print_win(&rows_win, 0, 4, global_color, "Rows");
+    print_win(&rows_win, 1, 5, global_color, "%03d", rows);
+}
+
+/**
+ * @brief Draw help box.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_help() {
+    fill_win(&help_win, global_color);
+    box_win(&help_win, global_color);
+    print_win(&help_win, 1, 3, global_color, "Press P to open the menu");
+}
+
+/**
+ * @brief Draw options menu.
+ *
+ * @param select selected element (enum options).
+ * @param ghost value of 'Ghost' option (enum ghost_option).
+ * @param color value of 'Color' option (enum color_option).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_options(int select, int ghost, int color) {
+    fill_win(&options_win, global_color);
+    box_win(&options_win, global_color);
+    print_win(&options_win, 0, 9, global_color, "OPTIONS");
+    print_win(&options_win, 2, 2, global_color, "Ghost:");
+    print_win(&options_win, 4, 2, global_color, "Color:");
+
+    int attr = global_color | ((select == OPTION_GHOST) ? ATTR_STANDOUT : 0);
+    switch (ghost) {
+        case OPT_GHOST_ON:
+            print_win(&options_win, 2, 11, attr, "<   On    >");
+            break;
+        case OPT_GHOST_OFF:
+            print_win(&options_win, 2, 11, attr, "<   Off   >");
+            break;
+    }
+
+    attr = global_color | ((select == OPTION_COLOR) ? ATTR_STANDOUT : 0);
+    switch (color) {
+        case OPT_COLOR_DEFAULT:
+            print_win(&options_win, 4, 11, attr, "< Default >");
+            break;
+        case OPT_COLOR_BLUE:
+            print_win(&options_win, 4, 11, attr, "<  Blue   >");
+            break;
+        case OPT_COLOR_BLACK:
+            print_win(&options_win, 4, 11, attr, "<  Black  >");
+            break;
+    }
+
+    print_win(&options_win, 6, 11, global_color | ((select == OPTION_OK) ? ATTR_STANDOUT : 0), "OK");
+}
+
+/**
+ * @brief Draw rules box.
+ *
+ * @param page current page (enum rules).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_rules(int page) {
+    fill_win(&rules_win, global_color);
+    box_win(&rules_win, global_color);
+    print_win(&rules_win, 0, 22, global_color, "RULES");
+
+    if (page == RULES_PAGE_1) {
+        print_win(&rules_win, 2, 2, global_color, "The goal of the game consists in positioning");
+        print_win(&rules_win, 4, 2, global_color, "each block without leaving holes. The complet-");
+        print_win(&rules_win, 6, 2, global_color, "ed rows are removed and the player gets points.");
+        print_win(&rules_win, 8, 2, global_color, "If multiple rows are completed simultaneously,");
+        print_win(&rules_win, 10, 2, global_color, "bonus points are obtained. By disabling the");
+        print_win(&rules_win, 12, 2, global_color, "option \'Ghost\', the points are doubled.");
+        print_win(&rules_win, 14, 23, global_color | ATTR_STANDOUT, "Next");
+    }
+    else if (page == RULES_PAGE_2) {
+        print_win(&rules_win, 2, 14, global_color, "P  open the menu");
+        print_win(&rules_win, 4, 5, global_color, "Left arrow  move block to the left");
+        print_win(&rules_win, 6, 4, global_color, "Right arrow  move block to the right");
+        print_win(&rules_win, 8, 7, global_color, "Up arrow  rotate block");
+        print_win(&rules_win, 10, 5, global_color, "Down arrow  move block down");
+        print_win(&rules_win, 12, 10, global_color, "Space  make the block fall fast");
+        print_win(&rules_win, 14, 24, global_color | ATTR_STANDOUT, "OK");
+    }
+}
+
+/**
+ * @brief Draw game menu.
+ *
+ * @param select selected element (enum game_menu).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_game_menu(int select) {
+    fill_win(&game_menu_win, global_color);
+    box_win(&game_menu_win, global_color);
+    print_win(&game_menu_win, 0, 5, global_color, "MENU");
+    print_win(&game_menu_win, 1, 4, global_color | ((select == MENU_PLAY) ? ATTR_STANDOUT : 0), "Resume");
+    print_win(&game_menu_win, 2, 4, global_color | ((select == MENU_RESTART) ? ATTR_STANDOUT : 0), "Restart");
+    print_win(&game_menu_win, 3, 5, global_color | ((select == MENU_BACK) ? ATTR_STANDOUT : 0), "Exit");
+}
+
+/**
+ * @brief Draw game over menu.
+ *
+ * @param select selected element (enum game_over).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_game_over(int select) {
+    fill_win(&game_over_win, global_color);
+    box_win(&game_over_win, global_color);
+    print_win(&game_over_win, 0, 3, global_color, "GAME OVER");
+    print_win(&game_over_win, 1, 4, global_color | ((select == GAME_OVER_RESTART) ? ATTR_STANDOUT : 0), "Restart");
+    print_win(&game_over_win, 2, 5, global_color | ((select == GAME_OVER_BACK) ? ATTR_STANDOUT : 0), "Exit");
+}
+
+/**
+ * @brief Draw a panel of the debug overlay.
+ *
+ * @param overlay panel (enum overlay).
+ * @param title title.
+ * @param lines text lines, at most OVERLAY_LINES of OVERLAY_WIDTH - 2 characters.
+ * @param count number of lines.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_overlay(int overlay, const char *title, const char *lines[], int count) {
+    Rect *w = &overlay_wins[overlay];
+    fill_win(w, global_color);
+    box_win(w, global_color);
+    print_win(w, 0, 3, global_color, "%s", title);
+    int i;
+    for (i = 0; i < count && i < OVERLAY_LINES; i++) {
+        print_win(w, i + 1, 1, global_color, "%s", lines[i]);
+    }
+}
+
+/**
+ * @brief Erase a panel of the debug overlay, restoring the background of the global window.
+ *
+ * @param overlay panel (enum overlay).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void erase_overlay(int overlay) {
+    fill_win(&overlay_wins[overlay], global_color);
+}
+const Renderer ANSI_RENDERER = {
+    init,
+    end,
+    init_windows,
+    change_global_color,
+    draw_global_win,
+    draw_main_menu,
+    draw_curr_field,
+    draw_next_field,
+    draw_stats,
+    draw_help,
+    draw_options,
+    draw_rules,
+    draw_game_menu,
+    draw_game_over,
+    draw_overlay,
+    erase_overlay,
+    present,
+    read_stdin_key
+};
+/** \} */
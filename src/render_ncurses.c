@@ -0,0 +1,715 @@
+/**
+ * @file render_ncurses.c
+ * @brief Terminal backend based on ncurses windows.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Utils
+ * @{
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ncurses.h>
+
+#include "shared.h"
+#include "layout.h"
+#include "renderer.h"
+
+
+#define STATS_INVALID -1 /**< @brief Value of a stats window that must be redrawn. */
+#define IO_PATH "/proc/self/io" /**< @brief I/O counters of the process: ncurses has no hook on its output. */
+#define IO_LENGTH 512 /**< @brief Max length of the I/O counters. */
+
+// menu windows
+static WINDOW *global_win;
+static WINDOW *options_win;
+static WINDOW *rules_win;
+static WINDOW *new_game_button;
+static WINDOW *autoplay_button;
+static WINDOW *options_button;
+static WINDOW *rules_button;
+static WINDOW *quit_button;
+
+// game windows
+static WINDOW *curr_field_win;
+static WINDOW *next_field_win;
+static WINDOW *level_win;
+static WINDOW *score_win;
+static WINDOW *rows_win;
+static WINDOW *help_win;
+static WINDOW *game_menu_win;
+static WINDOW *game_over_win;
+static WINDOW *overlay_wins[OVERLAYS];
+
+static int global_color; /**< @brief Global GUI color. */
+
+// statistics on screen (STATS_INVALID if the window must be redrawn)
+static int stats_level;
+static int stats_score;
+static int stats_rows;
+
+static int io_fd = -1; /**< @brief File descriptor of IO_PATH, -1 if it is not available. */
+
+/**
+ * @brief Force the next draw_stats() to redraw all the stats windows.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void invalidate_stats_win() {
+    stats_level = STATS_INVALID;
+    stats_score = STATS_INVALID;
+    stats_rows = STATS_INVALID;
+}
+
+void init_colors() {
+    start_color();
+    int color, pair;
+    for (color = COLOR_NEW_BLACK; color <= COLOR_NEW_BROWN; color++) {
+        init_color(color, COLOR_RGB[color - COLOR_NEW_BLACK][0], COLOR_RGB[color - COLOR_NEW_BLACK][1], COLOR_RGB[color - COLOR_NEW_BLACK][2]);
+    }
+    for (pair = BG; pair <= GUI_COLOR_BLACK; pair++) {
+        init_pair(pair, PAIR_COLORS[pair][0], PAIR_COLORS[pair][1]);
+    }
+}
+
+/**
+ * @brief Init window mode of ncurses.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init() {
+    // init window mode of ncurses
+    initscr();
+    // hide cursor
+    curs_set(0);
+    // prevent pressed keys from writing on the terminal
+    noecho();
+    init_colors();
+    // disable line buffering
+    cbreak();
+    // enable pressed keys acquisition
+    keypad(stdscr, TRUE);
+    // ncurses writes the terminal by itself: its output is measured by the counters of the process
+    io_fd = open(IO_PATH, O_RDONLY);
+}
+
+/**
+ * @brief Terminate window mode of ncurses.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void end() {
+    endwin();
+    if (io_fd != -1) {
+        close(io_fd);
+        io_fd = -1;
+    }
+}
+
+/**
+ * @brief Create windows.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_windows() {
+    global_color = GUI_COLOR_DEFAULT;
+    invalidate_stats_win();
+
+    // reference position to center the interface: refer to curr_field_win (double horizontal characters)
+    int curr_x = (COLS - CURR_WIDTH) / 2;
+    int curr_y = (LINES - CURR_HEIGHT - HELP_HEIGHT) / 2;
+
+    global_win = newwin(GLOBAL_HEIGHT, GLOBAL_WIDTH, curr_y - 1, curr_x - NEXT_WIDTH - 1);
+
+    options_win = newwin(OPTIONS_HEIGHT, OPTIONS_WIDTH, (LINES - OPTIONS_HEIGHT) / 2, (COLS - OPTIONS_WIDTH) / 2);
+    
+    rules_win = newwin(RULES_HEIGHT, RULES_WIDTH, (LINES - RULES_HEIGHT) / 2, (COLS - RULES_WIDTH) / 2);
+
+    new_game_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+
+    autoplay_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP + 1 + MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+    
+    options_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP + 2 + 2*MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+
+    rules_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP + 3 + 3*MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+   
+    quit_button = newwin(MENU_BUTTON_HEIGHT, MENU_BUTTON_WIDTH, curr_y + MENU_BUTTON_TOP + 4 + 4*MENU_BUTTON_HEIGHT, curr_x - (MENU_BUTTON_WIDTH - CURR_WIDTH) / 2);
+
+    curr_field_win = newwin(CURR_HEIGHT, CURR_WIDTH, curr_y, curr_x);
+
+    next_field_win = newwin(NEXT_HEIGHT, NEXT_WIDTH, curr_y, curr_x - NEXT_WIDTH);
+
+    level_win = newwin(STATS_HEIGHT, STATS_WIDTH, curr_y, curr_x + CURR_WIDTH);
+
+    score_win = newwin(STATS_HEIGHT, STATS_WIDTH, curr_y + STATS_HEIGHT, curr_x + CURR_WIDTH);
+
+    rows_win = newwin(STATS_HEIGHT, STATS_WIDTH, curr_y + 2*STATS_HEIGHT, curr_x + CURR_WIDTH);
+
+    help_win = newwin(HELP_HEIGHT, HELP_WIDTH, curr_y + CURR_HEIGHT, curr_x - (HELP_WIDTH - CURR_WIDTH) / 2);
+
+    game_menu_win = newwin(GAME_MENU_HEIGHT, GAME_MENU_WIDTH, (LINES - GAME_MENU_HEIGHT) / 2, (COLS - GAME_MENU_WIDTH) / 2);
+  
+    game_over_win = newwin(GAME_OVER_HEIGHT, GAME_OVER_WIDTH, (LINES - GAME_OVER_HEIGHT) / 2, (COLS - GAME_OVER_WIDTH) / 2);
+
+    // below the next-block area and the stats windows, next to the help box
+    overlay_wins[OVERLAY_PERF] = newwin(OVERLAY_HEIGHT, OVERLAY_WIDTH, curr_y + CURR_HEIGHT - OVERLAY_HEIGHT, curr_x - NEXT_WIDTH);
+    overlay_wins[OVERLAY_OUTPUT] = newwin(OVERLAY_HEIGHT, OVERLAY_WIDTH, curr_y + CURR_HEIGHT - OVERLAY_HEIGHT, curr_x + CURR_WIDTH);
+}
+
+/**
+ * @brief Change GUI global color.
+ *
+ * @param color global GUI color (enum gui_color).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void change_global_color(int color) {
+    global_color = color;
+    // update ghost background color
+    init_pair(GHOST, COLOR_NEW_WHITE, PAIR_COLORS[color][1]);
+    // colors of the stats windows must be updated
+    invalidate_stats_win();
+}
+
+/**
+ * @brief Draw global window.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_global_win() {
+    wbkgd(stdscr, COLOR_PAIR(global_color));
+    wnoutrefresh(stdscr);
+    wbkgd(global_win, COLOR_PAIR(global_color));
+    mvwprintw(global_win, 1, 6, TITLE);
+    box(global_win, 0, 0);
+    wnoutrefresh(global_win);
+    // the global window covers the stats windows
+    invalidate_stats_win();
+}
+
+/**
+ * @brief Draw main menu.
+ *
+ * @param select selected element (enum main_menu).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_main_menu(int select) {
+    wbkgd(new_game_button, COLOR_PAIR(global_color));
+    box(new_game_button, 0, 0);
+    if (select == NEW_GAME) {
+        wattron(new_game_button, A_STANDOUT);
+    }
+    mvwprintw(new_game_button, 1, 5, "NEW GAME");
+    wattroff(new_game_button, A_STANDOUT);
+
+    wbkgd(autoplay_button, COLOR_PAIR(global_color));
+    box(autoplay_button, 0, 0);
+    if (select == AUTOPLAY) {
+        wattron(autoplay_button, A_STANDOUT);
+    }
+    mvwprintw(autoplay_button, 1, 5, "AUTOPLAY");
+    wattroff(autoplay_button, A_STANDOUT);
+
+    wbkgd(options_button, COLOR_PAIR(global_color));
+    box(options_button, 0, 0);
+    if (select == OPTIONS) {
+        wattron(options_button, A_STANDOUT);
+    }
+    mvwprintw(options_button, 1, 5, "OPTIONS");
+    wattroff(options_button, A_STANDOUT);
+   
+    wbkgd(rules_button, COLOR_PAIR(global_color));
+    box(rules_button, 0, 0);
+    if (select == RULES) {
+        wattron(rules_button, A_STANDOUT);
+    }
+    mvwprintw(rules_button, 1, 6, "RULES");
+    wattroff(rules_button, A_STANDOUT);
+
+    wbkgd(quit_button, COLOR_PAIR(global_color));
+    box(quit_button, 0, 0);
+    if (select == QUIT) {
+        wattron(quit_button, A_STANDOUT);
+    }
+    mvwprintw(quit_button, 1, 6, "EXIT");
+    wattroff(quit_button, A_STANDOUT);
+
+    wnoutrefresh(new_game_button);
+    wnoutrefresh(autoplay_button);
+    wnoutrefresh(options_button);
+    wnoutrefresh(rules_button);
+    wnoutrefresh(quit_button);
+}
+
+/**
+ * @brief Draw main game area.
+ *
+ * @param f field pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_curr_field(Field *f) {
+    // background color
+    wbkgd(curr_field_win, COLOR_PAIR(global_color));
+    // border
+    box(curr_field_win, 0, 0);
+    int row, col;
+    int color;
+    for (row = 0; row < f->rows; row++) {
+        for (col = 0; col < f->cols; col++) {
+            color = f->grid[row][col];
+            wattrset(curr_field_win, COLOR_PAIR(color));
+            if (color != BG) {
+                mvwprintw(curr_field_win, row + 1, CHAR_PER_CELL*col + 1, "..");
+            }
+            else {
+                mvwprintw(curr_field_win, row + 1, CHAR_PER_CELL*col + 1, "  ");
+            }
+        }
+    }
+    wnoutrefresh(curr_field_win);
+}
+
+/**
+ * @brief Draw next-block area.
+ *
+ * @param f field pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_next_field(Field *f) {
+    wbkgd(next_field_win, COLOR_PAIR(global_color));
+    box(next_field_win, 0, 0);
+    mvwprintw(next_field_win, 0, 4, "Next");
+    int row, col;
+    int color;
+    for (row = 0; row < f->rows; row++) {
+        for (col = 0; col < f->cols; col++) {
+            color = f->grid[row][col];
+            wattrset(next_field_win, COLOR_PAIR(color));
+            if (color != BG) {
+                mvwprintw(next_field_win, row + 1, CHAR_PER_CELL*col + 1, "..");
+            }
+            else {
+                mvwprintw(next_field_win, row + 1, CHAR_PER_CELL*col + 1, "  ");
+            }
+        }
+    }
+    wnoutrefresh(next_field_win);
+}
+
+/**
+ * @brief Draw game statistics, skipping the windows whose number did not change.
+ *
+ * @param level level.
+ * @param score score.
+ * @param rows number of total deleted rows.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_stats(int level, int score, int rows) {
+    // windows whose number did not change are skipped
+    if (level != stats_level) {
+        wbkgd(level_win, COLOR_PAIR(global_color));
+        box(level_win, 0, 0);
+        mvwprintw(level_win, 0, 4, "Level");
+        mvwprintw(level_win, 1, 5, "%02d", level);
+        wnoutrefresh(level_win);
+        stats_level = level;
+    }
+
+    if (score != stats_score) {
+        wbkgd(score_win, COLOR_PAIR(global_color));
+        box(score_win, 0, 0);
+        mvwprintw(score_win, 0, 4, "Score");
+        mvwprintw(score_win, 1, 4, "%05d", score);
+        wnoutrefresh(score_win);
+        stats_score = score;
+    }
+
+    if (rows != stats_rows) {
+        wbkgd(rows_win, COLOR_PAIR(global_color));
+        box(rows_win, 0, 0);
+        mvwprintw(rows_win, 0, 4, "Rows");
+        mvwprintw(rows_win, 1, 5, "%03d", rows);
+        wnoutrefresh(rows_win);
+        stats_rows = rows;
+    }
+}
+
+/**
+ * @brief Draw help box.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_help() {
+    wbkgd(help_win, COLOR_PAIR(global_color));
+    box(help_win, 0, 0);
+    mvwprintw(help_win, 1, 3, "Press P to open the menu");
+
+    wnoutrefresh(help_win);
+}
+
+/**
+ * @brief Draw options menu.
+ *
+ * @param select selected element (enum options).
+ * @param ghost value of 'Ghost' option (enum ghost_option).
+ * @param color value of 'Color' option (enum color_option).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_options(int select, int ghost, int color) {
+    wbkgd(options_win, COLOR_PAIR(global_color));
+    box(options_win, 0, 0 );
+
+    mvwprintw(options_win, 0, 9, "OPTIONS");
+    mvwprintw(options_win, 2, 2, "Ghost:");
+    mvwprintw(options_win, 4, 2, "Color:");
+
+    if (select == OPTION_GHOST) {
+        wattron(options_win, A_STANDOUT);
+    }
+    switch (ghost) {
+        case OPT_GHOST_ON:
+            mvwprintw(options_win, 2, 11, "<   On    >");
+            break;
+        case OPT_GHOST_OFF:
+            mvwprintw(options_win, 2, 11, "<   Off   >");
+            break;
+    }
+    wattroff(options_win, A_STANDOUT);
+    
+    if (select == OPTION_COLOR) {
+        wattron(options_win, A_STANDOUT);
+    }
+    switch (color) {
+        case OPT_COLOR_DEFAULT:
+            mvwprintw(options_win, 4, 11, "< Default >");
+            break;
+        case OPT_COLOR_BLUE:
+            mvwprintw(options_win, 4, 11, "<  Blue   >");
+            break;
+        case OPT_COLOR_BLACK:
+            mvwprintw(options_win, 4, 11, "<  Black  >");
+            break;
+    }
+    wattroff(options_win, A_STANDOUT);
+
+    if (select == OPTION_OK) {
+        wattron(options_win, A_STANDOUT);
+    }
+    mvwprintw(options_win, 6, 11, "OK");
+    wattroff(options_win, A_STANDOUT);
+
+    wnoutrefresh(options_win);
+}
+
+/**
+ * @brief Draw rules box.
+ *
+ * @param page current page (enum rules).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_rules(int page) {
+    // cancella il contenuto
+    werase(rules_win);
+    wbkgd(rules_win, COLOR_PAIR(global_color));
+    box(rules_win, 0, 0 );
+    mvwprintw(rules_win, 0, 22, "RULES");
+
+    if (page == RULES_PAGE_1) {
+        mvwprintw(rules_win, 2, 2, "The goal of the game consists in positioning");
+        mvwprintw(rules_win, 4, 2, "each block without leaving holes. The complet-");
+        mvwprintw(rules_win, 6, 2, "ed rows are removed and the player gets points.");
+        mvwprintw(rules_win, 8, 2, "If multiple rows are completed simultaneously,");
+        mvwprintw(rules_win, 10, 2, "bonus points are obtained. By disabling the");
+        mvwprintw(rules_win, 12, 2, "option \'Ghost\', the points are doubled.");
+        wattron(rules_win, A_STANDOUT);
+        mvwprintw(rules_win, 14, 23, "Next");
+        wattroff(rules_win, A_STANDOUT);
+    }
+    else if (page == RULES_PAGE_2) {
+        mvwprintw(rules_win, 2, 14, "P  open the menu");
+        mvwprintw(rules_win, 4, 5, "Left arrow  move block to the left");
+        mvwprintw(rules_win, 6, 4, "Right arrow  move block to the right");
+        mvwprintw(rules_win, 8, 7, "Up arrow  rotate block");
+        mvwprintw(rules_win, 10, 5, "Down arrow  move block down");
+        mvwprintw(rules_win, 12, 10, "Space  make the block fall fast");
+        wattron(rules_win, A_STANDOUT);
+        mvwprintw(rules_win, 14, 24, "OK");
+        wattroff(rules_win, A_STANDOUT);
+    }
+    wnoutrefresh(rules_win);
+}
+
+/**
+ * @brief Draw game menu.
+ *
+ * @param select selected element (enum game_menu).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_game_menu(int select) {
+    wbkgd(game_menu_win, COLOR_PAIR(global_color));
+    box(game_menu_win, 0, 0 );
+    mvwprintw(game_menu_win, 0, 5, "MENU");
+
+    if (select == MENU_PLAY) {
+        wattron(game_menu_win, A_STANDOUT);
+    }
+    mvwprintw(game_menu_win, 1, 4, "Resume");
+    wattroff(game_menu_win, A_STANDOUT);
+            
+    if (select == MENU_RESTART) {
+        wattron(game_menu_win, A_STANDOUT);
+    }
+    mvwprintw(game_menu_win, 2, 4, "Restart");
+    wattroff(game_menu_win, A_STANDOUT);
+
+    if (select == MENU_BACK) {
+        wattron(game_menu_win, A_STANDOUT);
+    }
+    mvwprintw(game_menu_win, 3, 5, "Exit");
+    wattroff(game_menu_win, A_STANDOUT);      
+
+    wnoutrefresh(game_menu_win);
+}
+
+/**
+ * @brief Draw game over menu.
+ *
+ * @param select selected element (enum game_over).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_game_over(int select) {
+    wbkgd(game_over_win, COLOR_PAIR(global_color));
+    box(game_over_win, 0, 0 );
+    mvwprintw(game_over_win, 0, 3, "GAME OVER");
+ 
+    if (select == GAME_OVER_RESTART) {
+        wattron(game_over_win, A_STANDOUT);
+    }
+    mvwprintw(game_over_win, 1, 4, "Restart");
+    wattroff(game_over_win, A_STANDOUT);
+
+    if (select == GAME_OVER_BACK) {
+        wattron(game_over_win, A_STANDOUT);
+    }
+    mvwprintw(game_over_win, 2, 5, "Exit");
+    wattroff(game_over_win, A_STANDOUT);
+
+    wnoutrefresh(game_over_win);
+}
+
+/**
+ * @brief Draw a panel of the debug overlay.
+ *
+ * @param overlay panel (enum overlay).
+ * @param title title.
+ * @param lines text lines, at most OVERLAY_LINES of OVERLAY_WIDTH - 2 characters.
+ * @param count number of lines.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_overlay(int overlay, const char *title, const char *lines[], int count) {
+    WINDOW *w = overlay_wins[overlay];
+    wbkgd(w, COLOR_PAIR(global_color));
+    box(w, 0, 0);
+    mvwprintw(w, 0, 3, "%s", title);
+    int i;
+    for (i = 0; i < count && i < OVERLAY_LINES; i++) {
+        mvwprintw(w, i + 1, 1, "%s", lines[i]);
+    }
+    wnoutrefresh(w);
+}
+
+/**
+ * @brief Erase a panel of the debug overlay, restoring the background of the global window.
+ *
+ * @param overlay panel (enum overlay).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void erase_overlay(int overlay) {
+    WINDOW *w = overlay_wins[overlay];
+    wbkgd(w, COLOR_PAIR(global_color));
+    werase(w);
+    wnoutrefresh(w);
+}
+
+/**
+ * @brief Count the cells of the virtual screen that differ from the terminal.
+ *
+ * @return number of cells to redraw.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long count_changed_cells() {
+    chtype next[COLS + 1];
+    chtype curr[COLS + 1];
+    long cells = 0;
+    int new_y, new_x, cur_y, cur_x;
+    // reading moves the cursors, and the cursor of curscr is the one of the terminal
+    getyx(newscr, new_y, new_x);
+    getyx(curscr, cur_y, cur_x);
+    int y, x;
+    for (y = 0; y < LINES; y++) {
+        // only the lines copied by wnoutrefresh() since the last update can change
+        if (!is_linetouched(newscr, y)) {
+            continue;
+        }
+        mvwinchnstr(newscr, y, 0, next, COLS);
+        mvwinchnstr(curscr, y, 0, curr, COLS);
+        for (x = 0; x < COLS; x++) {
+            if (next[x] != curr[x]) {
+                cells++;
+            }
+        }
+    }
+    wmove(newscr, new_y, new_x);
+    wmove(curscr, cur_y, cur_x);
+    return cells;
+}
+
+/**
+ * @brief Read the bytes written and the write() system calls of the process so far.
+ *
+ * @param bytes number of bytes, set on success.
+ * @param flushes number of write() system calls, set on success.
+ * @return true on success, false if the counters are not available.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool read_io_counters(long *bytes, long *flushes) {
+    char text[IO_LENGTH];
+    ssize_t n = (io_fd == -1) ? -1 : pread(io_fd, text, sizeof(text) - 1, 0);
+    if (n <= 0) {
+        return false;
+    }
+    text[n] = '\0';
+    char *wchar = strstr(text, "wchar: ");
+    char *syscw = strstr(text, "syscw: ");
+    if (wchar == NULL || syscw == NULL) {
+        return false;
+    }
+    *bytes = atol(wchar + strlen("wchar: "));
+    *flushes = atol(syscw + strlen("syscw: "));
+    return true;
+}
+
+/**
+ * @brief Send the windows copied to the virtual screen to the terminal with a single flush.
+ *
+ * @param out output of the frame, set if not NULL.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void present(FrameOutput *out) {
+    if (out == NULL) {
+        doupdate();
+        return;
+    }
+    out->cells = count_changed_cells();
+    long bytes_before, flushes_before, bytes_after, flushes_after;
+    bool measured = read_io_counters(&bytes_before, &flushes_before);
+    doupdate();
+    // nothing else writes in between: the difference is the output of doupdate()
+    if (measured && read_io_counters(&bytes_after, &flushes_after)) {
+        out->bytes = bytes_after - bytes_before;
+        out->flushes = flushes_after - flushes_before;
+    }
+    else {
+        out->bytes = 0;
+        out->flushes = 0;
+    }
+}
+
+/**
+ * @brief Wait for a pressed key.
+ *
+ * @param timeout_millis max waiting time in milliseconds, -1 to wait indefinitely.
+ * @return pressed key, ERR on timeout or interruption.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int get_key(int timeout_millis) {
+    timeout(timeout_millis);
+    return getch();
+}
+
+const Renderer NCURSES_RENDERER = {
+    init,
+    end,
+    init_windows,
+    change_global_color,
+    draw_global_win,
+    draw_main_menu,
+    draw_curr_field,
+    draw_next_field,
+    draw_stats,
+    draw_help,
+    draw_options,
+    draw_rules,
+    draw_game_menu,
+    draw_game_over,
+    draw_overlay,
+    erase_overlay,
+    present,
+    get_key
+};
+/** \} */
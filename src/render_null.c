@@ -0,0 +1,268 @@
+/**
+ * @file render_null.c
+ * @brief Terminal backend that draws nothing and reads the keys from the standard input.
+ *
+ * Useful to run scripted sessions without a terminal, e.g. printf ' ' | TetrisC -r null.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Utils
+ * @{
+ */
+#include <stdlib.h>
+
+#include "shared.h"
+#include "renderer.h"
+
+
+/**
+ * @brief Init terminal: nothing to do.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init() {
+}
+
+/**
+ * @brief Restore terminal: nothing to do.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void end() {
+}
+
+/**
+ * @brief Init windows: nothing to do.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_windows() {
+}
+
+/**
+ * @brief Change GUI global color: ignored.
+ *
+ * @param color global GUI color (enum gui_color).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void change_global_color(int color) {
+    (void)color;
+}
+
+/**
+ * @brief Draw global window: ignored.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_global_win() {
+}
+
+/**
+ * @brief Draw main menu: ignored.
+ *
+ * @param select selected element (enum main_menu).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_main_menu(int select) {
+    (void)select;
+}
+
+/**
+ * @brief Draw main game area: ignored.
+ *
+ * @param f field pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_curr_field(Field *f) {
+    (void)f;
+}
+
+/**
+ * @brief Draw next-block area: ignored.
+ *
+ * @param f field pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_next_field(Field *f) {
+    (void)f;
+}
+
+/**
+ * @brief Draw game statistics: ignored.
+ *
+ * @param level level.
+ * @param score score.
+ * @param rows number of total deleted rows.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_stats(int level, int score, int rows) {
+    (void)level;
+    (void)score;
+    (void)rows;
+}
+
+/**
+ * @brief Draw help box: ignored.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_help() {
+}
+
+/**
+ * @brief Draw options menu: ignored.
+ *
+ * @param select selected element (enum options).
+ * @param ghost value of 'Ghost' option (enum ghost_option).
+ * @param color value of 'Color' option (enum color_option).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_options(int select, int ghost, int color) {
+    (void)select;
+    (void)ghost;
+    (void)color;
+}
+
+/**
+ * @brief Draw rules box: ignored.
+ *
+ * @param page current page (enum rules).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_rules(int page) {
+    (void)page;
+}
+
+/**
+ * @brief Draw game menu: ignored.
+ *
+ * @param select selected element (enum game_menu).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_game_menu(int select) {
+    (void)select;
+}
+
+/**
+ * @brief Draw game over menu: ignored.
+ *
+ * @param select selected element (enum game_over).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_game_over(int select) {
+    (void)select;
+}
+
+/**
+ * @brief Draw a panel of the debug overlay: ignored.
+ *
+ * @param overlay panel (enum overlay).
+ * @param title title.
+ * @param lines text lines.
+ * @param count number of lines.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_overlay(int overlay, const char *title, const char *lines[], int count) {
+    (void)overlay;
+    (void)title;
+    (void)lines;
+    (void)count;
+}
+
+/**
+ * @brief Erase a panel of the debug overlay: ignored.
+ *
+ * @param overlay panel (enum overlay).
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void erase_overlay(int overlay) {
+    (void)overlay;
+}
+
+/**
+ * @brief Send the frame to the terminal: nothing is written.
+ *
+ * @param out output of the frame, set to zero if not NULL.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void present(FrameOutput *out) {
+    if (out != NULL) {
+        out->cells = 0;
+        out->bytes = 0;
+        out->flushes = 0;
+    }
+}
+
+const Renderer NULL_RENDERER = {
+    init,
+    end,
+    init_windows,
+    change_global_color,
+    draw_global_win,
+    draw_main_menu,
+    draw_curr_field,
+    draw_next_field,
+    draw_stats,
+    draw_help,
+    draw_options,
+    draw_rules,
+    draw_game_menu,
+    draw_game_over,
+    draw_overlay,
+    erase_overlay,
+    present,
+    read_stdin_key
+};
+/** \} */
@@ -0,0 +1,306 @@
+/**
+ * @file rollout.c
+ * @brief Functions of a rollout planner, which values each placement by playing continuations of the game.
+ *
+ * From the board reached by each of the best placements of the falling block, the planner plays a
+ * number of continuations: the next block is known, the following ones are drawn from a generator with
+ * a new seed per continuation, and every block is placed by a cheap policy, random or greedy. The
+ * placement whose continuations survive most is chosen, then the one whose continuations end on the
+ * best boards (the deleted rows included). The continuations of a given index share their seed across
+ * the placements, so that the placements are compared on the same blocks. A continuation only copies
+ * states, which fit in a cache line, and its outcome is written in a buffer allocated with the planner:
+ * the continuations are shared among the threads of a pool, and a search neither allocates nor depends
+ * on the number of threads.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <float.h>
+
+#include "shared.h"
+#include "game.h"
+#include "state.h"
+#include "feature.h"
+#include "bot.h"
+#include "pool.h"
+#include "rollout.h"
+
+
+#define SEED_STRIDE 0x9e3779b9u /**< @brief Distance between the seeds of two continuations. */
+#define POLICY_SALT 0x85ebca6bu /**< @brief Mixed into the seed of a continuation to seed its random policy. */
+
+/**
+ * @struct Outcome
+ * @brief Outcome of a continuation.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    bool survived; /**< @brief Every block of the continuation was placed. */
+    double value; /**< @brief Weighted sum of the features of the last board, with the rows deleted since the root. */
+} Outcome;
+
+struct Rollout {
+    Weights weights; /**< @brief Weights of the board features. */
+    int candidates; /**< @brief Number of best placements of the falling block played out. */
+    int rollouts; /**< @brief Number of continuations per placement. */
+    int length; /**< @brief Number of blocks placed by a continuation. */
+    int policy; /**< @brief Policy of the continuations (enum rollout_policy). */
+    Pool *pool; /**< @brief Threads that play the continuations. */
+    GameState roots[MAX_PLACEMENTS]; /**< @brief States after the placements of the falling block. */
+    Placement placements[MAX_PLACEMENTS]; /**< @brief Placements of the falling block. */
+    double values[MAX_PLACEMENTS]; /**< @brief Values of the boards after the placements of the falling block. */
+    int count; /**< @brief Number of placements of the falling block played out. */
+    int root_rows; /**< @brief Number of deleted rows at the root of the search. */
+    unsigned int root_seed; /**< @brief Seed of the generator at the root of the search. */
+    Outcome *outcomes; /**< @brief Outcomes of the continuations, rollouts per placement. */
+};
+
+/**
+ * @brief Write the states reached by the placements of the falling block, with the values of their boards.
+ *
+ * Placements that end the game are dropped.
+ *
+ * @param r planner pointer.
+ * @param s state pointer, unchanged on return.
+ * @param states states, at least MAX_PLACEMENTS of them.
+ * @param placements placements, at least MAX_PLACEMENTS of them, or NULL.
+ * @param values values, at least MAX_PLACEMENTS of them.
+ * @return number of states.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int expand(Rollout *r, GameState *s, GameState states[], Placement placements[], double values[]) {
+    bool tried[4][COLUMNS + 2*PLACEMENT_COL_OFFSET] = {{false}};
+    BoardBatch batch;
+    FeatureBatch features;
+    int lines[MAX_PLACEMENTS];
+    int count = 0;
+    Undo u;
+    Placement p;
+    int k;
+    for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+        for (p.shift = -MAX_SHIFT; p.shift <= MAX_SHIFT; p.shift++) {
+            if (!apply_placement_state(s, p, &u)) {
+                continue;
+            }
+            bool *seen = &tried[u.lock_rot][u.lock_col + PLACEMENT_COL_OFFSET];
+            if (!*seen && u.result == TICK_LOCKED) {
+                states[count] = *s;
+                if (placements != NULL) {
+                    placements[count] = p;
+                }
+                lines[count] = s->rows - r->root_rows;
+                for (k = 0; k < ROWS; k++) {
+                    batch.rows[k][count] = s->board[k];
+                }
+                count++;
+            }
+            *seen = true;
+            undo_placement_state(s, &u);
+        }
+    }
+    extract_features(&batch, count, &features);
+    for (k = 0; k < count; k++) {
+        values[k] = evaluate_batch_bot(&features, k, lines[k], &r->weights);
+    }
+    return count;
+}
+
+/**
+ * @brief Greedy policy: place the falling block on the best board.
+ *
+ * @param r planner pointer.
+ * @param s state pointer.
+ * @return true if the block was placed, false if every placement ends the game.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool place_greedy(Rollout *r, GameState *s) {
+    GameState states[MAX_PLACEMENTS];
+    double values[MAX_PLACEMENTS];
+    int count = expand(r, s, states, NULL, values);
+    if (count == 0) {
+        return false;
+    }
+    int best = 0, i;
+    for (i = 1; i < count; i++) {
+        if (values[i] > values[best]) {
+            best = i;
+        }
+    }
+    *s = states[best];
+    return true;
+}
+
+/**
+ * @brief Random policy: place the falling block with a random rotation and shift.
+ *
+ * A shift that is blocked is replaced with no shift.
+ *
+ * @param s state pointer.
+ * @param rng seed of the policy.
+ * @return true if the block was placed, false if it ends the game.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool place_random(GameState *s, unsigned int *rng) {
+    Placement p;
+    Undo u;
+    p.rotations = rand_r(rng) % 4;
+    p.shift = rand_r(rng) % (2*MAX_SHIFT + 1) - MAX_SHIFT;
+    if (!apply_placement_state(s, p, &u)) {
+        p.shift = 0;
+        apply_placement_state(s, p, &u);
+    }
+    return u.result == TICK_LOCKED;
+}
+
+/**
+ * @brief Play a continuation from the state after a placement of the falling block.
+ *
+ * @param r planner pointer.
+ * @param i placement index.
+ * @param j continuation index.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void play_continuation(Rollout *r, int i, int j) {
+    GameState s = r->roots[i];
+    // the next block is known, the following ones are drawn again
+    unsigned int seed = r->root_seed + (j + 1)*SEED_STRIDE;
+    unsigned int rng = seed ^ POLICY_SALT;
+    reseed_state(&s, seed);
+    int n;
+    for (n = 0; n < r->length; n++) {
+        if (!(r->policy == ROLLOUT_GREEDY ? place_greedy(r, &s) : place_random(&s, &rng))) {
+            break;
+        }
+    }
+    Outcome *o = &r->outcomes[i*r->rollouts + j];
+    o->survived = n == r->length;
+    o->value = o->survived ? evaluate_state_bot(&s, s.rows - r->root_rows, &r->weights) : 0;
+}
+
+/**
+ * @brief Task of the pool: play the share of the continuations of a thread.
+ *
+ * @param arg planner pointer.
+ * @param id thread index: the continuations id, id + threads, and so on, of all the placements, are played.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void play_task(void *arg, int id) {
+    Rollout *r = arg;
+    int threads = get_threads_pool(r->pool);
+    int k;
+    for (k = id; k < r->count*r->rollouts; k += threads) {
+        play_continuation(r, k / r->rollouts, k % r->rollouts);
+    }
+}
+
+Rollout *create_rollout(const Weights *w, int candidates, int rollouts, int length, int policy, int threads) {
+    Rollout *r = malloc(sizeof(Rollout));
+    if (r == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    r->weights = *w;
+    r->candidates = candidates < 1 || candidates > MAX_PLACEMENTS ? MAX_PLACEMENTS : candidates;
+    r->rollouts = rollouts < 1 ? 1 : rollouts;
+    r->length = length < 0 ? 0 : length;
+    r->policy = policy;
+    r->outcomes = malloc(MAX_PLACEMENTS*r->rollouts*sizeof(Outcome));
+    if (r->outcomes == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    r->pool = create_pool(threads);
+    return r;
+}
+
+void delete_rollout(Rollout *r) {
+    delete_pool(r->pool);
+    free(r->outcomes);
+    free(r);
+}
+
+Placement find_placement_rollout(Rollout *r, Game *g) {
+    Placement best = {0, 0};
+    GameState s;
+    pack_state(&s, g);
+    r->root_rows = s.rows;
+    r->root_seed = s.seed;
+    int count = expand(r, &s, r->roots, r->placements, r->values);
+    int i, j;
+    // keep the best placements by value, in their order
+    while (count > r->candidates) {
+        int worst = 0;
+        for (i = 1; i < count; i++) {
+            if (r->values[i] <= r->values[worst]) {
+                worst = i;
+            }
+        }
+        count--;
+        for (i = worst; i < count; i++) {
+            r->roots[i] = r->roots[i + 1];
+            r->placements[i] = r->placements[i + 1];
+            r->values[i] = r->values[i + 1];
+        }
+    }
+    r->count = count;
+    run_pool(r->pool, play_task, r);
+
+    // the outcomes are summed in the same order, whatever the number of threads
+    int best_survivals = -1;
+    double best_value = -DBL_MAX;
+    for (i = 0; i < r->count; i++) {
+        int survivals = 0;
+        double value = 0;
+        for (j = 0; j < r->rollouts; j++) {
+            Outcome *o = &r->outcomes[i*r->rollouts + j];
+            if (o->survived) {
+                survivals++;
+                value += o->value;
+            }
+        }
+        value = survivals > 0 ? value / survivals : -DBL_MAX;
+        if (survivals > best_survivals || (survivals == best_survivals && value > best_value)) {
+            best_survivals = survivals;
+            best_value = value;
+            best = r->placements[i];
+        }
+    }
+    return best;
+}
+
+int play_block_rollout(Rollout *r, Game *g) {
+    place_block_game(g, find_placement_rollout(r, g));
+    int result;
+    do {
+        result = tick_game(g);
+    } while (result == TICK_MOVED);
+    return result;
+}
+/** \} */
@@ -0,0 +1,349 @@
+/**
+ * @file solver.c
+ * @brief Functions of a perfect-clear solver: place a fixed sequence of blocks so that the board is emptied.
+ *
+ * The solver searches the placements of the blocks depth first, applying and undoing them on a single
+ * state. A board is pruned if no prefix of the remaining blocks can empty it:
+ * - cell count: the cells of the board and of the blocks placed must fill whole rows, at least one per
+ *   row that is not empty (a pentomino adds 5 cells, I_SHORT 3);
+ * - parity: with an odd number of columns, a deleted row has one more cell in the even columns than in
+ *   the odd ones, so the imbalance of the board, minus one per deleted row, must be cancelled by the
+ *   imbalances of the blocks, each one bounded over its rotations.
+ * The boards that cannot be emptied by the remaining blocks are recorded in a visited set, keyed by the
+ * board and the remaining sequence; the set is the lock-free transposition table of table.c, so the
+ * records last across calls. The placements of the first block are shared among the threads of a pool;
+ * a thread gives up a subtree as soon as an earlier placement of the first block has a solution, so the
+ * solution is the first one in the order of the placements, whatever the number of threads.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <errno.h>
+
+#include "shared.h"
+#include "block.h"
+#include "state.h"
+#include "pool.h"
+#include "table.h"
+#include "solver.h"
+
+
+#define EVEN_COLUMNS (0x5555 & ((1 << COLUMNS) - 1)) /**< @brief Mask of the even columns of a row. */
+
+/**
+ * @struct Search
+ * @brief Search of a thread.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    GameState state; /**< @brief State of the search. */
+    Placement path[SOLVER_MAX_PIECES]; /**< @brief Placements of the blocks from the root. */
+    int length; /**< @brief Number of blocks of the solution, if found. */
+    int task; /**< @brief Placement of the first block of the solution, if found; -1 otherwise. */
+    long nodes; /**< @brief Number of boards searched. */
+} Search;
+
+struct Solver {
+    Pool *pool; /**< @brief Threads that search the placements of the first block. */
+    Table *table; /**< @brief Boards that cannot be emptied by the remaining blocks. */
+    int cells[I_SHORT + 1]; /**< @brief Number of cells of each block type. */
+    int imbalance[I_SHORT + 1]; /**< @brief Max difference between the cells in even and odd columns of each block type. */
+    GameState root; /**< @brief State at the root, with the first block falling. */
+    uint8_t types[SOLVER_MAX_PIECES]; /**< @brief Types of the blocks. */
+    uint64_t suffixes[SOLVER_MAX_PIECES + 1]; /**< @brief Hash of the remaining blocks, after each number of placed ones. */
+    int count; /**< @brief Number of blocks. */
+    Placement tasks[MAX_PLACEMENTS]; /**< @brief Placements of the first block. */
+    int task_count; /**< @brief Number of placements of the first block. */
+    int best_task; /**< @brief First placement of the first block with a solution, task_count if none yet. */
+    Search searches[POOL_MAX_THREADS]; /**< @brief Searches of the threads. */
+};
+
+/**
+ * @brief Count the cells of a board, and the difference between the cells in the even and odd columns.
+ *
+ * @param s state pointer.
+ * @param imbalance difference, written.
+ * @param used number of rows that are not empty, written.
+ * @return number of cells.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int count_cells(GameState *s, int *imbalance, int *used) {
+    int cells = 0, even = 0;
+    int row;
+    *used = 0;
+    for (row = ROWS - 1; row >= 0; row--) {
+        if (s->board[row] != 0) {
+            cells += __builtin_popcount(s->board[row]);
+            even += __builtin_popcount(s->board[row] & EVEN_COLUMNS);
+            (*used)++;
+        }
+    }
+    *imbalance = 2*even - cells;
+    return cells;
+}
+
+/**
+ * @brief Check if a prefix of the remaining blocks may empty a board, by cell count and parity.
+ *
+ * @param sv solver pointer.
+ * @param s state pointer.
+ * @param i number of placed blocks.
+ * @return false if no prefix can empty the board.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool may_clear(Solver *sv, GameState *s, int i) {
+    int imbalance, used;
+    int cells = count_cells(s, &imbalance, &used);
+    int reach = 0;
+    int k;
+    for (k = i; k < sv->count; k++) {
+        cells += sv->cells[sv->types[k]];
+        reach += sv->imbalance[sv->types[k]];
+        if (cells % COLUMNS != 0) {
+            continue;
+        }
+        // every row that is not empty must be deleted, each one with one more cell in the even columns
+        int rows = cells / COLUMNS;
+        if (rows >= used && abs(rows - imbalance) <= reach) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Check if the search of a placement of the first block can stop, since an earlier one has a solution.
+ *
+ * @param sv solver pointer.
+ * @param task placement of the first block.
+ * @return true if the search can stop.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool is_preempted(Solver *sv, int task) {
+    return __atomic_load_n(&sv->best_task, __ATOMIC_RELAXED) < task;
+}
+
+/**
+ * @brief Depth-first search of the placements of the remaining blocks.
+ *
+ * @param sv solver pointer.
+ * @param x search pointer: its state holds the board after i blocks; on a solution, its path holds the placements.
+ * @param i number of placed blocks.
+ * @param task placement of the first block.
+ * @return true if the board is emptied.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool search(Solver *sv, Search *x, int i, int task) {
+    GameState *s = &x->state;
+    x->nodes++;
+    int imbalance, used;
+    if (count_cells(s, &imbalance, &used) == 0) {
+        x->length = i;
+        return true;
+    }
+    if (!may_clear(sv, s, i) || is_preempted(sv, task)) {
+        return false;
+    }
+    uint64_t key = mix_hash_table(hash_state_table(s, false), sv->suffixes[i]);
+    double value;
+    if (probe_table(sv->table, key, &value, NULL, NULL)) {
+        return false;
+    }
+
+    spawn_block_state(s, sv->types[i], 0);
+    bool tried[4][COLUMNS + 2*PLACEMENT_COL_OFFSET] = {{false}};
+    Undo u;
+    Placement p;
+    for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+        for (p.shift = -MAX_SHIFT; p.shift <= MAX_SHIFT; p.shift++) {
+            if (!apply_placement_state(s, p, &u)) {
+                continue;
+            }
+            bool *seen = &tried[u.lock_rot][u.lock_col + PLACEMENT_COL_OFFSET];
+            if (!*seen && u.result == TICK_LOCKED) {
+                x->path[i] = p;
+                if (search(sv, x, i + 1, task)) {
+                    return true;
+                }
+            }
+            *seen = true;
+            undo_placement_state(s, &u);
+        }
+    }
+    // a subtree given up early is not proved
+    if (!is_preempted(sv, task)) {
+        Placement none = {0, 0};
+        store_table(sv->table, key, 0, sv->count - i, none);
+    }
+    return false;
+}
+
+/**
+ * @brief Task of the pool: search the share of the placements of the first block of a thread.
+ *
+ * @param arg solver pointer.
+ * @param id thread index: the placements id, id + threads, and so on are searched.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void solve_task(void *arg, int id) {
+    Solver *sv = arg;
+    Search *x = &sv->searches[id];
+    int threads = get_threads_pool(sv->pool);
+    Undo u;
+    int t;
+    for (t = id; t < sv->task_count && !is_preempted(sv, t); t += threads) {
+        x->state = sv->root;
+        apply_placement_state(&x->state, sv->tasks[t], &u);
+        x->path[0] = sv->tasks[t];
+        if (search(sv, x, 1, t)) {
+            x->task = t;
+            // keep the first placement with a solution
+            int best = __atomic_load_n(&sv->best_task, __ATOMIC_RELAXED);
+            while (t < best && !__atomic_compare_exchange_n(&sv->best_task, &best, t, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+            break;
+        }
+    }
+}
+
+Solver *create_solver(int threads, size_t table_bytes) {
+    Solver *sv = malloc(sizeof(Solver));
+    if (sv == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    Block b;
+    int cells[BLOCK_MAX_SIZE][2];
+    int type, rot, i;
+    for (type = F; type <= I_SHORT; type++) {
+        sv->imbalance[type] = 0;
+        for (rot = 0; rot < 4; rot++) {
+            init_block(&b, type, rot, 0, 0);
+            sv->cells[type] = get_cells_block(&b, cells);
+            int even = 0;
+            for (i = 0; i < sv->cells[type]; i++) {
+                even += (cells[i][1] & 1) == 0;
+            }
+            // on a column of the other parity, the difference changes sign
+            int imbalance = abs(2*even - sv->cells[type]);
+            if (imbalance > sv->imbalance[type]) {
+                sv->imbalance[type] = imbalance;
+            }
+        }
+    }
+    sv->pool = create_pool(threads);
+    sv->table = create_table(table_bytes);
+    sv->task_count = 0;
+    return sv;
+}
+
+void delete_solver(Solver *sv) {
+    delete_pool(sv->pool);
+    delete_table(sv->table);
+    free(sv);
+}
+
+int solve_solver(Solver *sv, const GameState *s, const uint8_t types[], int count, Placement solution[]) {
+    GameState root = *s;
+    Search *x = &sv->searches[0];
+    int threads = get_threads_pool(sv->pool);
+    int i;
+    if (count < 0 || count > SOLVER_MAX_PIECES) {
+        errno = EINVAL;
+        ERROR_EXIT("solve_solver");
+    }
+    sv->count = count;
+    sv->suffixes[sv->count] = 0;
+    for (i = sv->count - 1; i >= 0; i--) {
+        sv->types[i] = types[i];
+        sv->suffixes[i] = mix_hash_table(sv->suffixes[i + 1], types[i]);
+    }
+    for (i = 0; i < threads; i++) {
+        sv->searches[i].task = -1;
+        sv->searches[i].nodes = 0;
+    }
+
+    // the root is searched by the calling thread, up to the placements of the first block
+    sv->task_count = 0;
+    sv->best_task = INT_MAX;
+    x->state = root;
+    x->nodes = 1;
+    int imbalance, used;
+    if (count_cells(&root, &imbalance, &used) == 0) {
+        return 0;
+    }
+    if (sv->count == 0 || !may_clear(sv, &root, 0)) {
+        return -1;
+    }
+    spawn_block_state(&root, sv->types[0], 0);
+    sv->root = root;
+    bool tried[4][COLUMNS + 2*PLACEMENT_COL_OFFSET] = {{false}};
+    Undo u;
+    Placement p;
+    for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+        for (p.shift = -MAX_SHIFT; p.shift <= MAX_SHIFT; p.shift++) {
+            if (!apply_placement_state(&root, p, &u)) {
+                continue;
+            }
+            bool *seen = &tried[u.lock_rot][u.lock_col + PLACEMENT_COL_OFFSET];
+            if (!*seen && u.result == TICK_LOCKED) {
+                sv->tasks[sv->task_count++] = p;
+            }
+            *seen = true;
+            undo_placement_state(&root, &u);
+        }
+    }
+    sv->best_task = sv->task_count;
+    age_table(sv->table);
+    run_pool(sv->pool, solve_task, sv);
+
+    for (i = 0; i < threads; i++) {
+        x = &sv->searches[i];
+        if (x->task >= 0 && x->task == sv->best_task) {
+            int k;
+            for (k = 0; k < x->length; k++) {
+                solution[k] = x->path[k];
+            }
+            return x->length;
+        }
+    }
+    return -1;
+}
+
+long get_nodes_solver(Solver *sv) {
+    long nodes = 0;
+    int i;
+    for (i = 0; i < get_threads_pool(sv->pool); i++) {
+        nodes += sv->searches[i].nodes;
+    }
+    return nodes;
+}
+/** \} */
@@ -0,0 +1,525 @@
+/**
+ * @file state.c
+ * @brief Functions to run a game on its compact state, with the same rules as game.c, for the search of the bots.
+ *
+ * Rows of the game area are bit masks and the falling block is a position: a state is a few dozen
+ * bytes, that a search copies by assignment instead of copying whole game areas. Threads that explore
+ * the same position each take their own copy: the 22 rows take 44 bytes, less than the pointers to
+ * shared rows would. The shapes of the blocks are read once from block.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "shared.h"
+#include "block.h"
+#include "state.h"
+
+
+#define FULL_ROW ((1 << COLUMNS) - 1) /**< @brief Mask of a completed row. */
+
+/**
+ * @struct Shape
+ * @brief Cells of a block type in a rotation.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int count; /**< @brief Number of cells. */
+    int cells[BLOCK_MAX_SIZE][2]; /**< @brief Row and column offsets of the cells from the rotation center. */
+    int low; /**< @brief Min row offset. */
+    int high; /**< @brief Max row offset. */
+    int rotation_count; /**< @brief Number of cells checked to rotate. */
+    int rotation_cells[ROTATION_MAX_CELLS][2]; /**< @brief Row and column offsets of the cells checked to rotate. */
+} Shape;
+
+static Shape shapes[I_SHORT + 1][4]; /**< @brief Shapes, by block type and rotation. */
+static pthread_once_t shapes_once = PTHREAD_ONCE_INIT; /**< @brief Guard to read the shapes once. */
+
+/**
+ * @brief Read the shapes of all the block types from block.c.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_shapes() {
+    Block b;
+    int type, rot;
+    for (type = F; type <= I_SHORT; type++) {
+        for (rot = 0; rot < 4; rot++) {
+            Shape *shape = &shapes[type][rot];
+            init_block(&b, type, rot, 0, 0);
+            shape->count = get_cells_block(&b, shape->cells);
+            shape->rotation_count = get_rotation_cells_block(&b, shape->rotation_cells);
+            shape->low = get_limit_low_block(&b);
+            shape->high = get_limit_high_block(&b);
+        }
+    }
+}
+
+/**
+ * @brief Check if cells are inside the game area and free, as can_move_block() and can_rotate_block().
+ *
+ * Cells above the game area are free.
+ *
+ * @param s state pointer.
+ * @param cells row and column offsets of the cells.
+ * @param count number of cells.
+ * @param row rotation center row.
+ * @param col rotation center column.
+ * @return true if all the cells are free, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool are_free_cells(GameState *s, const int cells[][2], int count, int row, int col) {
+    int i;
+    for (i = 0; i < count; i++) {
+        int r = row + cells[i][0];
+        int c = col + cells[i][1];
+        if (c < 0 || c >= COLUMNS || r >= ROWS) {
+            return false;
+        }
+        if (r >= 0 && (s->board[r] >> c & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Check if the falling block fits in a position, in its current rotation.
+ *
+ * @param s state pointer.
+ * @param row rotation center row.
+ * @param col rotation center column.
+ * @return true if it fits, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool fits_block(GameState *s, int row, int col) {
+    Shape *shape = &shapes[s->type][s->rot];
+    return are_free_cells(s, shape->cells, shape->count, row, col);
+}
+
+/**
+ * @brief Check if the falling block can move in a direction.
+ *
+ * @param s state pointer.
+ * @param dir direction.
+ * @return true if it can move, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool can_move(GameState *s, int dir) {
+    return fits_block(s, s->row + (dir == DOWN), s->col + (dir == RIGHT) - (dir == LEFT));
+}
+
+/**
+ * @brief Check if the falling block can rotate.
+ *
+ * @param s state pointer.
+ * @return true if it can rotate, false otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool can_rotate(GameState *s) {
+    Shape *shape = &shapes[s->type][s->rot];
+    return are_free_cells(s, shape->rotation_cells, shape->rotation_count, s->row, s->col);
+}
+
+/**
+ * @brief Move the falling block in a direction, without checks.
+ *
+ * @param s state pointer.
+ * @param dir direction.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void apply_move(GameState *s, int dir) {
+    s->row += (dir == DOWN);
+    s->col += (dir == RIGHT) - (dir == LEFT);
+}
+
+/**
+ * @brief Rotate the falling block, without checks.
+ *
+ * @param s state pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void apply_rotation(GameState *s) {
+    s->rot = (s->rot + 1) % 4;
+}
+
+/**
+ * @brief Init next block with a random type and rotation.
+ *
+ * @param s state pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_next_block(GameState *s) {
+    s->next_type = rand_r(&s->seed) % I_SHORT + 1;
+    s->next_rot = rand_r(&s->seed) % 4;
+}
+
+/**
+ * @brief Drop the next block from the top of the game area.
+ *
+ * @param s state pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void drop_block(GameState *s) {
+    spawn_block_state(s, s->next_type, s->next_rot);
+    init_next_block(s);
+}
+
+/**
+ * @brief Find a completed row, from the bottom.
+ *
+ * @param s state pointer.
+ * @param from min row index.
+ * @param to max row index.
+ * @return index of the row, or -1 if there is none.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int find_row(GameState *s, int from, int to) {
+    int row;
+    for (row = to; row >= from; row--) {
+        if (s->board[row] == FULL_ROW) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Fix block position after failed rotation, as in game.c.
+ *
+ * @param s state pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void fix_block_position(GameState *s) {
+    // if possible, move left
+    if (can_move(s, LEFT)) {
+        apply_move(s, LEFT);
+        // if possible, rotate
+        if (can_rotate(s)) {
+            apply_rotation(s);
+        }
+        // if possible, move left again
+        else if (can_move(s, LEFT)) {
+            apply_move(s, LEFT);
+            // if possible, rotate
+            if (can_rotate(s)) {
+                apply_rotation(s);
+            }
+            // otherwise reset it to the initial position, by moving it twice to the right
+            else {
+                apply_move(s, RIGHT);
+                apply_move(s, RIGHT);
+            }
+        }
+        else {
+            // otherwise reset it to the initial position, by moving it once to the right
+            apply_move(s, RIGHT);
+        }
+    }
+
+    // if possible, move right
+    if (can_move(s, RIGHT)) {
+        apply_move(s, RIGHT);
+        // if possible, rotate
+        if (can_rotate(s)) {
+            apply_rotation(s);
+        }
+        // if possible, move right again
+        else if (can_move(s, RIGHT)) {
+            apply_move(s, RIGHT);
+            // if possible, rotate
+            if (can_rotate(s)) {
+                apply_rotation(s);
+            }
+            // otherwise reset it to the initial position, by moving it twice to the left
+            else {
+                apply_move(s, LEFT);
+                apply_move(s, LEFT);
+            }
+        }
+        else {
+            // otherwise reset it to the initial position, by moving it once to the left
+            apply_move(s, LEFT);
+        }
+    }
+}
+
+/**
+ * @brief Lock the falling block, delete the completed rows, update the statistics and drop the next block.
+ *
+ * @param s state pointer.
+ * @param u record of the deleted rows and of the gains, or NULL.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void lock_block(GameState *s, Undo *u) {
+    Shape *shape = &shapes[s->type][s->rot];
+    int low = s->row + shape->low;
+    int high = s->row + shape->high;
+    int i;
+    for (i = 0; i < shape->count; i++) {
+        s->board[s->row + shape->cells[i][0]] |= 1 << (s->col + shape->cells[i][1]);
+    }
+
+    // delete the completed rows among the ones occupied by the block
+    int level = s->level;
+    int rows_count = 0;
+    int row_to_clear = find_row(s, low, high);
+    while (row_to_clear != -1) {
+        memmove(&s->board[1], &s->board[0], row_to_clear*sizeof(s->board[0]));
+        s->board[0] = 0;
+        s->rows++;
+        // level up
+        if (s->rows % ROWS_PER_LEVEL == 0 && s->level < LEVEL_CAP) {
+            s->level++;
+        }
+        if (u != NULL) {
+            u->cleared[rows_count] = row_to_clear;
+        }
+        rows_count++;
+        row_to_clear = find_row(s, low, high);
+    }
+
+    // update score with bonus, BONUS_EXPONENT is 2
+    int bonus = (s->ghost == OPT_GHOST_OFF) ? BONUS_GHOST_OFF : 1;
+    int score = SCORE_PER_ROW*rows_count*rows_count*bonus;
+    s->score += score;
+    if (u != NULL) {
+        u->cleared_count = rows_count;
+        u->level_delta = s->level - level;
+        u->score_delta = score;
+    }
+
+    // drop new block
+    drop_block(s);
+}
+
+void init_state(GameState *s, int ghost, unsigned int seed) {
+    pthread_once(&shapes_once, init_shapes);
+    memset(s, 0, sizeof(GameState));
+    s->level = 1;
+    s->ghost = ghost;
+    s->seed = seed;
+
+    init_next_block(s);
+
+    drop_block(s);
+}
+
+void pack_state(GameState *s, Game *g) {
+    pthread_once(&shapes_once, init_shapes);
+    memset(s, 0, sizeof(GameState));
+    int row, col, i;
+    for (row = 0; row < ROWS; row++) {
+        for (col = 0; col < COLUMNS; col++) {
+            if (g->curr_field->grid[row][col] != BG && g->curr_field->grid[row][col] != GHOST) {
+                s->board[row] |= 1 << col;
+            }
+        }
+    }
+    s->type = g->curr_block->type;
+    s->rot = g->curr_block->rot;
+    s->row = g->curr_block->row;
+    s->col = g->curr_block->col;
+    // the falling block is not locked
+    Shape *shape = &shapes[s->type][s->rot];
+    for (i = 0; i < shape->count; i++) {
+        if (s->row + shape->cells[i][0] >= 0) {
+            s->board[s->row + shape->cells[i][0]] &= ~(1 << (s->col + shape->cells[i][1]));
+        }
+    }
+    s->next_type = g->next_block->type;
+    s->next_rot = g->next_block->rot;
+    s->level = g->level;
+    s->rows = g->rows;
+    s->score = g->score;
+    s->ghost = g->ghost;
+    s->seed = g->seed;
+}
+
+void get_queue_state(GameState *s, int count, uint8_t types[], uint8_t rots[]) {
+    // the blocks are drawn from the same generator, on a copy of its seed
+    unsigned int seed = s->seed;
+    int type = s->next_type, rot = s->next_rot;
+    int i;
+    for (i = 0; i < count; i++) {
+        types[i] = type;
+        rots[i] = rot;
+        type = rand_r(&seed) % I_SHORT + 1;
+        rot = rand_r(&seed) % 4;
+    }
+}
+
+void spawn_block_state(GameState *s, int type, int rot) {
+    s->type = type;
+    s->rot = rot;
+    s->row = -BLOCK_MAX_SIZE;
+    s->col = COLUMNS / 2;
+    // move down until the first cell of the block appears on the screen
+    while (s->row + shapes[s->type][s->rot].high < 0 && can_move(s, DOWN)) {
+        apply_move(s, DOWN);
+    }
+}
+
+void reseed_state(GameState *s, unsigned int seed) {
+    s->seed = seed;
+    init_next_block(s);
+}
+
+int tick_state(GameState *s) {
+    if (can_move(s, DOWN)) {
+        apply_move(s, DOWN);
+        return TICK_MOVED;
+    }
+
+    // check if the whole block appears on the screen: if not it is game over
+    if (s->row + shapes[s->type][s->rot].low < 0) {
+        return TICK_GAME_OVER;
+    }
+
+    lock_block(s, NULL);
+    return TICK_LOCKED;
+}
+
+bool move_block_state(GameState *s, int dir) {
+    if (!can_move(s, dir)) {
+        return false;
+    }
+    apply_move(s, dir);
+    return true;
+}
+
+void rotate_block_state(GameState *s) {
+    if (can_rotate(s)) {
+        apply_rotation(s);
+    }
+    else {
+        fix_block_position(s);
+    }
+}
+
+void fall_block_state(GameState *s) {
+    while (can_move(s, DOWN)) {
+        apply_move(s, DOWN);
+    }
+}
+
+bool place_block_state(GameState *s, Placement p) {
+    int i;
+    for (i = 0; i < p.rotations; i++) {
+        rotate_block_state(s);
+    }
+    for (i = 0; i < abs(p.shift); i++) {
+        if (!move_block_state(s, p.shift < 0 ? LEFT : RIGHT)) {
+            return false;
+        }
+    }
+    fall_block_state(s);
+    return true;
+}
+
+bool apply_placement_state(GameState *s, Placement p, Undo *u) {
+    u->seed = s->seed;
+    u->type = s->type;
+    u->rot = s->rot;
+    u->row = s->row;
+    u->col = s->col;
+    u->next_type = s->next_type;
+    u->next_rot = s->next_rot;
+    u->cleared_count = 0;
+    u->level_delta = 0;
+    u->score_delta = 0;
+    if (!place_block_state(s, p)) {
+        s->rot = u->rot;
+        s->row = u->row;
+        s->col = u->col;
+        return false;
+    }
+    u->lock_rot = s->rot;
+    u->lock_row = s->row;
+    u->lock_col = s->col;
+    // check if the whole block appears on the screen: if not it is game over
+    if (s->row + shapes[s->type][s->rot].low < 0) {
+        u->result = TICK_GAME_OVER;
+        return true;
+    }
+    lock_block(s, u);
+    u->result = TICK_LOCKED;
+    return true;
+}
+
+void undo_placement_state(GameState *s, Undo *u) {
+    int i;
+    if (u->result == TICK_LOCKED) {
+        // insert again the deleted rows, which were completed, from the last one
+        for (i = u->cleared_count - 1; i >= 0; i--) {
+            memmove(&s->board[0], &s->board[1], u->cleared[i]*sizeof(s->board[0]));
+            s->board[u->cleared[i]] = FULL_ROW;
+        }
+        // erase the locked block
+        Shape *shape = &shapes[u->type][u->lock_rot];
+        for (i = 0; i < shape->count; i++) {
+            s->board[u->lock_row + shape->cells[i][0]] &= ~(1 << (u->lock_col + shape->cells[i][1]));
+        }
+        s->rows -= u->cleared_count;
+        s->level -= u->level_delta;
+        s->score -= u->score_delta;
+    }
+    s->seed = u->seed;
+    s->type = u->type;
+    s->rot = u->rot;
+    s->row = u->row;
+    s->col = u->col;
+    s->next_type = u->next_type;
+    s->next_rot = u->next_rot;
+}
+/** \} */
@@ -0,0 +1,146 @@
+/**
+ * @file table.c
+ * @brief Functions of a transposition table shared by the threads of a search, without locks.
+ *
+ * An entry is three 64-bit words: the value, the packed metadata (depth, generation of the search and
+ * best placement), and the key xor-ed with both of them. Each word is loaded and stored atomically, but
+ * an entry as a whole is not: two threads may interleave their stores in the same slot, or a load may
+ * see a store half done. Such an entry no longer matches the key xor-ed with its words, so it reads as
+ * a miss, and no lock is needed. The table is direct-mapped: an entry replaces the one in its slot if
+ * that one is from a previous search, or if it was not searched deeper.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "shared.h"
+#include "table.h"
+
+
+#define HASH_BASIS 14695981039346656037ULL /**< @brief Offset basis of the FNV-1a hash. */
+#define HASH_PRIME 1099511628211ULL /**< @brief Prime of the FNV-1a hash. */
+#define DEPTH_SHIFT 0 /**< @brief Position of the depth in the metadata. */
+#define GENERATION_SHIFT 8 /**< @brief Position of the generation of the search in the metadata. */
+#define ROTATIONS_SHIFT 16 /**< @brief Position of the rotations of the best placement in the metadata. */
+#define SHIFT_SHIFT 24 /**< @brief Position of the shift of the best placement, plus 128, in the metadata. */
+
+/**
+ * @struct Entry
+ * @brief Entry of a table; the empty entry, all zeros, matches no key since the keys are never 0.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    uint64_t check; /**< @brief Key xor-ed with the other words. */
+    uint64_t value; /**< @brief Bits of the value. */
+    uint64_t meta; /**< @brief Packed depth, generation and best placement. */
+} Entry;
+
+struct Table {
+    Entry *entries; /**< @brief Entries. */
+    size_t mask; /**< @brief Number of entries minus 1. */
+    uint8_t generation; /**< @brief Generation of the current search. */
+};
+
+Table *create_table(size_t bytes) {
+    Table *t = malloc(sizeof(Table));
+    if (t == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    if (bytes == 0) {
+        bytes = TABLE_DEFAULT_BYTES;
+    }
+    size_t size = 1;
+    while (size*2*sizeof(Entry) <= bytes) {
+        size *= 2;
+    }
+    t->entries = calloc(size, sizeof(Entry));
+    if (t->entries == NULL) {
+        ERROR_EXIT("calloc");
+    }
+    t->mask = size - 1;
+    t->generation = 0;
+    return t;
+}
+
+void delete_table(Table *t) {
+    free(t->entries);
+    free(t);
+}
+
+size_t get_size_table(Table *t) {
+    return t->mask + 1;
+}
+
+void age_table(Table *t) {
+    t->generation++;
+}
+
+uint64_t hash_state_table(const GameState *s, bool block) {
+    uint64_t h = HASH_BASIS;
+    int row;
+    for (row = 0; row < ROWS; row++) {
+        h = mix_hash_table(h, s->board[row]);
+    }
+    if (block) {
+        h = mix_hash_table(h, s->type);
+        h = mix_hash_table(h, s->rot);
+        h = mix_hash_table(h, (uint8_t)s->row);
+        h = mix_hash_table(h, (uint8_t)s->col);
+    }
+    return h;
+}
+
+uint64_t mix_hash_table(uint64_t h, uint64_t v) {
+    // the value is never 0 once mixed, so that no key matches the empty entry
+    return ((h ^ v)*HASH_PRIME) | 1;
+}
+
+bool probe_table(Table *t, uint64_t key, double *value, int *depth, Placement *best) {
+    Entry *e = &t->entries[key & t->mask];
+    uint64_t check = __atomic_load_n(&e->check, __ATOMIC_RELAXED);
+    uint64_t bits = __atomic_load_n(&e->value, __ATOMIC_RELAXED);
+    uint64_t meta = __atomic_load_n(&e->meta, __ATOMIC_RELAXED);
+    if ((check ^ bits ^ meta) != key) {
+        return false;
+    }
+    memcpy(value, &bits, sizeof(double));
+    if (depth != NULL) {
+        *depth = (uint8_t)(meta >> DEPTH_SHIFT);
+    }
+    if (best != NULL) {
+        best->rotations = (uint8_t)(meta >> ROTATIONS_SHIFT);
+        best->shift = (int)(uint8_t)(meta >> SHIFT_SHIFT) - 128;
+    }
+    return true;
+}
+
+void store_table(Table *t, uint64_t key, double value, int depth, Placement best) {
+    Entry *e = &t->entries[key & t->mask];
+    uint64_t old = __atomic_load_n(&e->meta, __ATOMIC_RELAXED);
+    if ((uint8_t)(old >> GENERATION_SHIFT) == t->generation && (uint8_t)(old >> DEPTH_SHIFT) > depth) {
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(double));
+    uint64_t meta = (uint64_t)(uint8_t)depth << DEPTH_SHIFT | (uint64_t)t->generation << GENERATION_SHIFT
+                    | (uint64_t)(uint8_t)best.rotations << ROTATIONS_SHIFT | (uint64_t)(uint8_t)(best.shift + 128) << SHIFT_SHIFT;
+    __atomic_store_n(&e->check, key ^ bits ^ meta, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->value, bits, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->meta, meta, __ATOMIC_RELAXED);
+}
+/** \} */
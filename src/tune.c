@@ -0,0 +1,411 @@
+/**
+ * @file tune.c
+ * @brief Tuner of the weights of the bot: populations of candidate weights play seeded headless games.
+ *
+ * The tuner runs the cross-entropy method with a diagonal Gaussian: each generation samples a population
+ * of weights around a mean, plays the same seeded games with every candidate, and moves the mean and the
+ * deviations to those of the best quarter of the population. Games are played by the bot on compact
+ * states, without a game nor a GUI, by the threads of a pool. After each generation the mean, the
+ * deviations and the best candidate are written to a checkpoint (to a temporary file, then renamed, so
+ * that an interruption never leaves it half written); if the checkpoint exists at start, the tuner
+ * resumes from it. The samples of a generation are drawn from a seed of their own, so a resumed run
+ * plays the same generations as an uninterrupted one.
+ *
+ * Usage: TetrisTune [-p population] [-G generations] [-g games] [-n max_pieces] [-t threads] [-s seed] [-c checkpoint].
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shared.h"
+#include "state.h"
+#include "bot.h"
+#include "pool.h"
+
+
+#define WEIGHT_COUNT 7 /**< @brief Number of weights of the bot. */
+#define DEFAULT_POPULATION 32 /**< @brief Default number of candidates per generation. */
+#define MAX_POPULATION 1024 /**< @brief Max number of candidates per generation. */
+#define DEFAULT_GENERATIONS 20 /**< @brief Default number of generations. */
+#define DEFAULT_GAMES 8 /**< @brief Default number of games per candidate. */
+#define DEFAULT_MAX_PIECES 500 /**< @brief Default max number of blocks per game. */
+#define DEFAULT_SEED 2017 /**< @brief Default seed of the samples and of the games. */
+#define DEFAULT_CHECKPOINT "tune.ckpt" /**< @brief Default path of the checkpoint. */
+#define ELITE_DIVISOR 4 /**< @brief The best population / ELITE_DIVISOR candidates are the elite. */
+#define INITIAL_SIGMA 0.5 /**< @brief Initial deviation of every weight. */
+#define MIN_SIGMA 0.02 /**< @brief Min deviation of every weight, so that the search never stops. */
+#define SEED_STRIDE 7919 /**< @brief Distance between the seeds of two generations. */
+#define PATH_LENGTH 4096 /**< @brief Max length of the path of the checkpoint. */
+
+/**
+ * @struct Checkpoint
+ * @brief State of the tuner after a generation.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    int generation; /**< @brief Number of completed generations. */
+    double mean[WEIGHT_COUNT]; /**< @brief Mean of the weights. */
+    double sigma[WEIGHT_COUNT]; /**< @brief Deviation of the weights. */
+    double best[WEIGHT_COUNT]; /**< @brief Best candidate of the last generation. */
+    double fitness; /**< @brief Mean number of deleted rows per game of the best candidate. */
+} Checkpoint;
+
+/**
+ * @struct Rank
+ * @brief Fitness of a candidate, to sort the population.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    double fitness; /**< @brief Mean number of deleted rows per game. */
+    int index; /**< @brief Index of the candidate. */
+} Rank;
+
+static const char *NAMES[WEIGHT_COUNT] = {"height", "lines", "holes", "bumpiness", "row_transitions", "col_transitions", "wells"}; /**< @brief Names of the weights. */
+
+static int population = DEFAULT_POPULATION; /**< @brief Number of candidates per generation. */
+static int games = DEFAULT_GAMES; /**< @brief Number of games per candidate. */
+static int max_pieces = DEFAULT_MAX_PIECES; /**< @brief Max number of blocks per game. */
+static unsigned int games_seed; /**< @brief Seed of the first game of the current generation. */
+static Bot *bots[MAX_POPULATION]; /**< @brief One bot per candidate. */
+static long *lines; /**< @brief Deleted rows of each game of each candidate. */
+static long *pieces; /**< @brief Locked blocks of each game of each candidate. */
+
+/**
+ * @brief Copy weights into an array.
+ *
+ * @param w weights pointer.
+ * @param a array of WEIGHT_COUNT weights.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void get_array(const Weights *w, double a[]) {
+    a[0] = w->height;
+    a[1] = w->lines;
+    a[2] = w->holes;
+    a[3] = w->bumpiness;
+    a[4] = w->row_transitions;
+    a[5] = w->col_transitions;
+    a[6] = w->wells;
+}
+
+/**
+ * @brief Copy an array into weights.
+ *
+ * @param w weights pointer.
+ * @param a array of WEIGHT_COUNT weights.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void set_array(Weights *w, const double a[]) {
+    w->height = a[0];
+    w->lines = a[1];
+    w->holes = a[2];
+    w->bumpiness = a[3];
+    w->row_transitions = a[4];
+    w->col_transitions = a[5];
+    w->wells = a[6];
+}
+
+/**
+ * @brief Draw a standard normal sample (Box-Muller transform).
+ *
+ * @param seed seed of the generator.
+ * @return sample.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static double draw_normal(unsigned int *seed) {
+    double u = (rand_r(seed) + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand_r(seed) + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2*log(u))*cos(2*M_PI*v);
+}
+
+/**
+ * @brief Task of the pool: play the share of the games of a thread, all the candidates together.
+ *
+ * @param arg pool pointer.
+ * @param id thread index: the games id, id + threads, and so on are played.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void play_task(void *arg, int id) {
+    Pool *pool = arg;
+    int threads = get_threads_pool(pool);
+    GameState s;
+    int k, p;
+    for (k = id; k < population*games; k += threads) {
+        // every candidate plays the same games
+        init_state(&s, OPT_GHOST_OFF, games_seed + k % games);
+        for (p = 0; p < max_pieces; p++) {
+            if (play_block_state_bot(bots[k / games], &s) == TICK_GAME_OVER) {
+                break;
+            }
+        }
+        lines[k] = s.rows;
+        pieces[k] = p;
+    }
+}
+
+/**
+ * @brief Compare two ranks: the higher fitness first, then the lower index.
+ *
+ * @param a first rank.
+ * @param b second rank.
+ * @return negative if a comes first, positive otherwise.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static int compare_ranks(const void *a, const void *b) {
+    const Rank *x = a, *y = b;
+    if (x->fitness != y->fitness) {
+        return x->fitness < y->fitness ? 1 : -1;
+    }
+    return x->index - y->index;
+}
+
+/**
+ * @brief Read a checkpoint.
+ *
+ * @param path path of the checkpoint.
+ * @param c checkpoint pointer, written if the file exists and is complete.
+ * @return true if the checkpoint was read.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static bool read_checkpoint(const char *path, Checkpoint *c) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return false;
+    }
+    Checkpoint read;
+    bool ok = fscanf(f, " generation %d", &read.generation) == 1;
+    int i;
+    for (i = 0; ok && i < WEIGHT_COUNT; i++) {
+        ok = fscanf(f, " %*s %lf %lf %lf", &read.mean[i], &read.sigma[i], &read.best[i]) == 3;
+    }
+    ok = ok && fscanf(f, " fitness %lf", &read.fitness) == 1;
+    fclose(f);
+    if (ok) {
+        *c = read;
+    }
+    return ok;
+}
+
+/**
+ * @brief Write a checkpoint to a temporary file, then rename it to its path.
+ *
+ * @param path path of the checkpoint.
+ * @param c checkpoint pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void write_checkpoint(const char *path, Checkpoint *c) {
+    char tmp[PATH_LENGTH + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "w");
+    if (f == NULL) {
+        ERROR_EXIT("fopen");
+    }
+    fprintf(f, "generation %d\n", c->generation);
+    int i;
+    for (i = 0; i < WEIGHT_COUNT; i++) {
+        // name, mean, deviation and best candidate, exact in decimal
+        fprintf(f, "%s %.17g %.17g %.17g\n", NAMES[i], c->mean[i], c->sigma[i], c->best[i]);
+    }
+    fprintf(f, "fitness %.17g\n", c->fitness);
+    if (fflush(f) != 0 || fsync(fileno(f)) != 0) {
+        ERROR_EXIT("fsync");
+    }
+    fclose(f);
+    if (rename(tmp, path) != 0) {
+        ERROR_EXIT("rename");
+    }
+}
+
+/**
+ * @brief Return the time of CLOCK_MONOTONIC in seconds.
+ *
+ * @return seconds.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static double now_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Tuner routine.
+ *
+ * @param argc number of arguments.
+ * @param argv arguments.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+int main(int argc, char *argv[]) {
+    int generations = DEFAULT_GENERATIONS;
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int seed = DEFAULT_SEED;
+    const char *path = DEFAULT_CHECKPOINT;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:G:g:n:t:s:c:")) != -1) {
+        if (opt == 'p' && atoi(optarg) >= ELITE_DIVISOR) {
+            population = atoi(optarg) > MAX_POPULATION ? MAX_POPULATION : atoi(optarg);
+        }
+        else if (opt == 'G' && atoi(optarg) > 0) {
+            generations = atoi(optarg);
+        }
+        else if (opt == 'g' && atoi(optarg) > 0) {
+            games = atoi(optarg);
+        }
+        else if (opt == 'n' && atoi(optarg) > 0) {
+            max_pieces = atoi(optarg);
+        }
+        else if (opt == 't' && atoi(optarg) > 0) {
+            threads = atoi(optarg);
+        }
+        else if (opt == 's') {
+            seed = strtoul(optarg, NULL, 10);
+        }
+        else if (opt == 'c' && strlen(optarg) < PATH_LENGTH) {
+            path = optarg;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-p population] [-G generations] [-g games] [-n max_pieces] [-t threads] [-s seed] [-c checkpoint]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Checkpoint c;
+    if (read_checkpoint(path, &c)) {
+        printf("Resumed from %s after generation %d\n", path, c.generation);
+    }
+    else {
+        c.generation = 0;
+        get_array(&DEFAULT_WEIGHTS, c.mean);
+        get_array(&DEFAULT_WEIGHTS, c.best);
+        int i;
+        for (i = 0; i < WEIGHT_COUNT; i++) {
+            c.sigma[i] = INITIAL_SIGMA;
+        }
+        c.fitness = 0;
+    }
+
+    lines = malloc(population*games*sizeof(long));
+    pieces = malloc(population*games*sizeof(long));
+    if (lines == NULL || pieces == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    double (*samples)[WEIGHT_COUNT] = malloc(population*sizeof(*samples));
+    Rank *ranks = malloc(population*sizeof(Rank));
+    if (samples == NULL || ranks == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    int i, j, k;
+    for (i = 0; i < population; i++) {
+        bots[i] = create_bot(&DEFAULT_WEIGHTS);
+    }
+    Pool *pool = create_pool(threads);
+    int elite = population / ELITE_DIVISOR;
+
+    while (c.generation < generations) {
+        // the samples and the games of a generation do not depend on the previous runs
+        unsigned int sample_seed = seed + c.generation*SEED_STRIDE;
+        games_seed = sample_seed;
+        for (i = 0; i < population; i++) {
+            for (j = 0; j < WEIGHT_COUNT; j++) {
+                samples[i][j] = c.mean[j] + c.sigma[j]*draw_normal(&sample_seed);
+            }
+            set_array(&bots[i]->weights, samples[i]);
+        }
+
+        double start = now_seconds();
+        run_pool(pool, play_task, pool);
+        double seconds = now_seconds() - start;
+
+        long total_pieces = 0;
+        for (i = 0; i < population; i++) {
+            long total_lines = 0;
+            for (k = 0; k < games; k++) {
+                total_lines += lines[i*games + k];
+                total_pieces += pieces[i*games + k];
+            }
+            ranks[i].fitness = (double)total_lines / games;
+            ranks[i].index = i;
+        }
+        qsort(ranks, population, sizeof(Rank), compare_ranks);
+
+        // mean and deviation of the elite
+        for (j = 0; j < WEIGHT_COUNT; j++) {
+            double mean = 0, variance = 0;
+            for (i = 0; i < elite; i++) {
+                mean += samples[ranks[i].index][j] / elite;
+            }
+            for (i = 0; i < elite; i++) {
+                double d = samples[ranks[i].index][j] - mean;
+                variance += d*d / elite;
+            }
+            c.mean[j] = mean;
+            c.sigma[j] = sqrt(variance) > MIN_SIGMA ? sqrt(variance) : MIN_SIGMA;
+            c.best[j] = samples[ranks[0].index][j];
+        }
+        c.fitness = ranks[0].fitness;
+        c.generation++;
+        write_checkpoint(path, &c);
+
+        printf("Generation %d: best %.1f, median %.1f rows per game, %.0f pieces/s\n", c.generation,
+               ranks[0].fitness, ranks[population / 2].fitness, total_pieces / seconds);
+        fflush(stdout);
+    }
+
+    printf("Mean weights:\n");
+    for (j = 0; j < WEIGHT_COUNT; j++) {
+        printf("    %g, // %s\n", c.mean[j], NAMES[j]);
+    }
+
+    delete_pool(pool);
+    for (i = 0; i < population; i++) {
+        delete_bot(bots[i]);
+    }
+    free(ranks);
+    free(samples);
+    free(pieces);
+    free(lines);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file vec_env.c
+ * @brief Functions of a vectorised environment, which steps many headless games at once for a trainer.
+ *
+ * Each game is a GameState, and each step places the falling block of every game, as the bots do,
+ * split among the threads of a pool. The observations, rewards and done flags are written in place in
+ * a buffer of the caller, which may be shared memory mapped by the trainer in another process, so
+ * nothing is copied between the games and the trainer. A game that ends is started again at once,
+ * with a seed drawn from its own generator.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+// memfd_create()
+#define _GNU_SOURCE
+
+/**
+ * @addtogroup Game
+ * @{
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "shared.h"
+#include "block.h"
+#include "state.h"
+#include "pool.h"
+#include "vec_env.h"
+
+
+struct VecEnv {
+    int count; /**< @brief Number of games. */
+    GameState *states; /**< @brief Games. */
+    unsigned int *seeds; /**< @brief Generator of the seeds of each game. */
+    Observation *observations; /**< @brief Observations, in the buffer. */
+    float *rewards; /**< @brief Rewards, in the buffer. */
+    uint8_t *dones; /**< @brief Done flags, in the buffer. */
+    const int *actions; /**< @brief Actions of the running step. */
+    Pool *pool; /**< @brief Threads that step the games. */
+};
+
+/**
+ * @brief Round a size up to the alignment of the arrays of a buffer.
+ *
+ * @param bytes size in bytes.
+ * @return aligned size in bytes.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static size_t align_size(size_t bytes) {
+    return (bytes + VEC_ENV_ALIGNMENT - 1) / VEC_ENV_ALIGNMENT*VEC_ENV_ALIGNMENT;
+}
+
+/**
+ * @brief Write the observation of a game.
+ *
+ * @param s state pointer.
+ * @param o observation pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void observe(GameState *s, Observation *o) {
+    int row, col, i;
+    for (row = 0; row < ROWS; row++) {
+        for (col = 0; col < COLUMNS; col++) {
+            o->cells[row][col] = (s->board[row] >> col) & 1 ? CELL_FILLED : CELL_EMPTY;
+        }
+    }
+    Block b;
+    int cells[BLOCK_MAX_SIZE][2];
+    init_block(&b, s->type, s->rot, s->row, s->col);
+    int count = get_cells_block(&b, cells);
+    for (i = 0; i < count; i++) {
+        if (s->row + cells[i][0] >= 0) {
+            o->cells[s->row + cells[i][0]][s->col + cells[i][1]] = CELL_FALLING;
+        }
+    }
+
+    // after the rotations, the block moves as far as the first blocked shift on each side
+    GameState rotated = *s, moved;
+    int rotations, shift;
+    for (rotations = 0; rotations < 4; rotations++) {
+        if (rotations > 0) {
+            rotate_block_state(&rotated);
+        }
+        int left = 0, right = 0;
+        for (moved = rotated; left < MAX_SHIFT && move_block_state(&moved, LEFT); left++);
+        for (moved = rotated; right < MAX_SHIFT && move_block_state(&moved, RIGHT); right++);
+        for (shift = -MAX_SHIFT; shift <= MAX_SHIFT; shift++) {
+            o->legal[rotations*VEC_ENV_SHIFTS + shift + MAX_SHIFT] = shift >= -left && shift <= right;
+        }
+    }
+    o->type = s->type;
+    o->rot = s->rot;
+    o->next_type = s->next_type;
+    o->next_rot = s->next_rot;
+    o->level = s->level;
+    o->reserved[0] = 0;
+}
+
+/**
+ * @brief Start a new game.
+ *
+ * @param v environment pointer.
+ * @param i index of the game.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void reset_game(VecEnv *v, int i) {
+    init_state(&v->states[i], OPT_GHOST_OFF, rand_r(&v->seeds[i]));
+}
+
+/**
+ * @brief Task of the pool: step the share of the games of a thread.
+ *
+ * @param arg environment pointer.
+ * @param id thread index: the games id, id + threads, and so on are stepped.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void step_task(void *arg, int id) {
+    VecEnv *v = arg;
+    int threads = get_threads_pool(v->pool);
+    Undo u;
+    int i;
+    for (i = id; i < v->count; i += threads) {
+        GameState *s = &v->states[i];
+        int action = v->actions[i];
+        Placement p = {0, 0};
+        if (action >= 0 && action < VEC_ENV_ACTIONS) {
+            p.rotations = action / VEC_ENV_SHIFTS;
+            p.shift = action % VEC_ENV_SHIFTS - MAX_SHIFT;
+        }
+        if (!apply_placement_state(s, p, &u)) {
+            p.shift = 0;
+            apply_placement_state(s, p, &u);
+        }
+        v->rewards[i] = u.result == TICK_LOCKED ? u.cleared_count : 0;
+        v->dones[i] = u.result == TICK_GAME_OVER;
+        if (v->dones[i]) {
+            reset_game(v, i);
+        }
+        observe(s, &v->observations[i]);
+    }
+}
+
+size_t get_buffer_size_vec_env(int count) {
+    return align_size(count*sizeof(Observation)) + align_size(count*sizeof(float)) + align_size(count*sizeof(uint8_t));
+}
+
+void *map_shared_vec_env(int count, int *fd) {
+    size_t size = get_buffer_size_vec_env(count);
+    // not closed on exec: a trainer started by this process inherits it
+    *fd = memfd_create("vec_env", 0);
+    if (*fd == -1) {
+        ERROR_EXIT("memfd_create");
+    }
+    if (ftruncate(*fd, size) == -1) {
+        ERROR_EXIT("ftruncate");
+    }
+    void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+    if (buffer == MAP_FAILED) {
+        ERROR_EXIT("mmap");
+    }
+    return buffer;
+}
+
+void unmap_shared_vec_env(void *buffer, int count, int fd) {
+    munmap(buffer, get_buffer_size_vec_env(count));
+    close(fd);
+}
+
+VecEnv *create_vec_env(int count, const unsigned int seeds[], int threads, void *buffer) {
+    if (count <= 0 || count > VEC_ENV_MAX_ENVS || threads <= 0 || threads > POOL_MAX_THREADS) {
+        errno = EINVAL;
+        ERROR_EXIT("create_vec_env");
+    }
+    VecEnv *v = malloc(sizeof(VecEnv));
+    if (v == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    v->count = count;
+    v->states = malloc(count*sizeof(GameState));
+    v->seeds = malloc(count*sizeof(unsigned int));
+    if (v->states == NULL || v->seeds == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    memcpy(v->seeds, seeds, count*sizeof(unsigned int));
+    // the padding between the arrays too, so that the whole buffer depends only on the games
+    memset(buffer, 0, get_buffer_size_vec_env(count));
+    v->observations = buffer;
+    v->rewards = (float *)((char *)buffer + align_size(count*sizeof(Observation)));
+    v->dones = (uint8_t *)((char *)v->rewards + align_size(count*sizeof(float)));
+    v->pool = create_pool(threads);
+    reset_vec_env(v);
+    return v;
+}
+
+void delete_vec_env(VecEnv *v) {
+    delete_pool(v->pool);
+    free(v->seeds);
+    free(v->states);
+    free(v);
+}
+
+Observation *get_observations_vec_env(VecEnv *v) {
+    return v->observations;
+}
+
+float *get_rewards_vec_env(VecEnv *v) {
+    return v->rewards;
+}
+
+uint8_t *get_dones_vec_env(VecEnv *v) {
+    return v->dones;
+}
+
+void reset_vec_env(VecEnv *v) {
+    int i;
+    for (i = 0; i < v->count; i++) {
+        reset_game(v, i);
+        observe(&v->states[i], &v->observations[i]);
+        v->rewards[i] = 0;
+        v->dones[i] = 0;
+    }
+}
+
+void step_vec_env(VecEnv *v, const int actions[]) {
+    v->actions = actions;
+    run_pool(v->pool, step_task, v);
+}
+/** \} */
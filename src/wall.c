@@ -0,0 +1,330 @@
+/**
+ * @file wall.c
+ * @brief Wall of boards: watch many simulated games at once.
+ *
+ * Games are simulated at full speed by worker threads. At a throttled rate the viewer asks each game
+ * for a snapshot of its board, which the worker copies between two pieces under a sequence lock,
+ * so the simulation never waits for the terminal. Each terminal cell shows two rows of a board with
+ * a half-block character.
+ *
+ * Usage: TetrisWall [-g games] [-t threads], press Q to quit.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <locale.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <ncurses.h>
+
+#include "shared.h"
+#include "layout.h"
+#include "renderer.h"
+#include "game.h"
+#include "bot.h"
+
+
+#define WALL_FPS 10 /**< @brief Number of snapshots per second requested to each game on screen. */
+#define DEFAULT_GAMES 24 /**< @brief Default number of simulated games. */
+#define MAX_THREADS 256 /**< @brief Max number of worker threads. */
+#define TILE_WIDTH (COLUMNS + 1) /**< @brief Width of a board on screen, gap included. */
+#define TILE_HEIGHT ((ROWS + 1) / 2 + 1) /**< @brief Height of a board on screen, gap included. */
+#define HALF_BLOCK "\xe2\x96\x80" /**< @brief Upper half block (U+2580) in UTF-8. */
+#define HALF_PAIR_BASE (GUI_COLOR_BLACK + 1) /**< @brief First color pair of the half-block pairs. */
+#define KEY_QUIT 'q' /**< @brief Key Q. */
+
+/**
+ * @struct Snapshot
+ * @brief Last board published by a game.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    atomic_uint seq; /**< @brief Sequence lock: odd while the worker is writing the board. */
+    atomic_bool requested; /**< @brief Set by the viewer to ask for a new board. */
+    unsigned char grid[ROWS][COLUMNS]; /**< @brief Board. */
+} Snapshot;
+
+/**
+ * @struct Worker
+ * @brief Worker thread simulating a subset of the games.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+typedef struct {
+    pthread_t thread; /**< @brief Thread. */
+    int first; /**< @brief Index of the first game. */
+    int step; /**< @brief Stride between the games of the worker. */
+    atomic_long pieces; /**< @brief Number of locked blocks. */
+    atomic_long games; /**< @brief Number of finished games. */
+} Worker;
+
+static int games_count = DEFAULT_GAMES; /**< @brief Number of simulated games. */
+static int threads_count; /**< @brief Number of worker threads. */
+static Snapshot *snapshots; /**< @brief One snapshot per game. */
+static Worker workers[MAX_THREADS]; /**< @brief Worker threads. */
+static atomic_bool running; /**< @brief False when the workers must stop. */
+static bool half_pairs; /**< @brief True if the terminal has enough color pairs for two colors per cell. */
+
+/**
+ * @brief Copy the board of a game to its snapshot, if the viewer asked for it.
+ *
+ * @param s snapshot pointer.
+ * @param g game pointer.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void publish_snapshot(Snapshot *s, Game *g) {
+    // a single relaxed load per block when no one is watching
+    if (!atomic_load_explicit(&s->requested, memory_order_relaxed)) {
+        return;
+    }
+    unsigned int seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    int row, col;
+    for (row = 0; row < ROWS; row++) {
+        for (col = 0; col < COLUMNS; col++) {
+            s->grid[row][col] = g->curr_field->grid[row][col];
+        }
+    }
+    atomic_store_explicit(&s->seq, seq + 2, memory_order_release);
+    atomic_store_explicit(&s->requested, false, memory_order_relaxed);
+}
+
+/**
+ * @brief Worker routine: let the bot play its games one block at a time, restarting them on game over.
+ *
+ * @param arg worker pointer.
+ * @return NULL.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void *worker_routine(void *arg) {
+    Worker *w = arg;
+    int count = (games_count - w->first + w->step - 1) / w->step;
+    Game **games = malloc(count*sizeof(Game *));
+    if (games == NULL) {
+        ERROR_EXIT("malloc");
+    }
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    unsigned int seed = time(NULL) + w->first;
+    int i;
+    for (i = 0; i < count; i++) {
+        games[i] = create_game();
+        init_game(games[i], OPT_GHOST_OFF, rand_r(&seed));
+    }
+
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        for (i = 0; i < count; i++) {
+            if (play_block_bot(bot, games[i]) == TICK_GAME_OVER) {
+                init_game(games[i], OPT_GHOST_OFF, rand_r(&seed));
+                atomic_fetch_add_explicit(&w->games, 1, memory_order_relaxed);
+            }
+            atomic_fetch_add_explicit(&w->pieces, 1, memory_order_relaxed);
+            publish_snapshot(&snapshots[w->first + i*w->step], games[i]);
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        delete_game(games[i]);
+    }
+    free(games);
+    delete_bot(bot);
+    return NULL;
+}
+
+/**
+ * @brief Read the last board published by a game, if it is consistent.
+ *
+ * @param s snapshot pointer.
+ * @param grid destination board, unchanged if the worker was writing it.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void read_snapshot(Snapshot *s, unsigned char grid[ROWS][COLUMNS]) {
+    unsigned char copy[ROWS][COLUMNS];
+    unsigned int before = atomic_load_explicit(&s->seq, memory_order_acquire);
+    if (before % 2 != 0) {
+        return;
+    }
+    memcpy(copy, s->grid, sizeof(copy));
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&s->seq, memory_order_relaxed) == before) {
+        memcpy(grid, copy, sizeof(copy));
+    }
+}
+
+/**
+ * @brief Init the color pairs of the game and one pair per couple of block types sharing a cell.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void init_half_pairs() {
+    init_colors();
+    half_pairs = COLOR_PAIRS >= HALF_PAIR_BASE + (GHOST + 1)*(GHOST + 1);
+    if (!half_pairs) {
+        return;
+    }
+    int upper, lower;
+    for (upper = BG; upper <= GHOST; upper++) {
+        for (lower = BG; lower <= GHOST; lower++) {
+            // foreground draws the upper half, background the lower half
+            init_pair(HALF_PAIR_BASE + upper*(GHOST + 1) + lower, PAIR_COLORS[upper][1], PAIR_COLORS[lower][1]);
+        }
+    }
+}
+
+/**
+ * @brief Draw a board, two rows per terminal line.
+ *
+ * @param grid board.
+ * @param y top line.
+ * @param x left column.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void draw_board(unsigned char grid[ROWS][COLUMNS], int y, int x) {
+    int row, col;
+    for (row = 0; row < ROWS; row += 2) {
+        for (col = 0; col < COLUMNS; col++) {
+            int upper = grid[row][col];
+            int lower = (row + 1 < ROWS) ? grid[row + 1][col] : BG;
+            if (half_pairs) {
+                attr_set(A_NORMAL, HALF_PAIR_BASE + upper*(GHOST + 1) + lower, NULL);
+                mvaddstr(y + row / 2, x + col, HALF_BLOCK);
+            }
+            else {
+                // one color per cell: show the occupied half
+                attr_set(A_NORMAL, (upper != BG) ? upper : lower, NULL);
+                mvaddch(y + row / 2, x + col, ' ');
+            }
+        }
+    }
+}
+
+/**
+ * @brief Wall routine.
+ *
+ * @param argc number of arguments.
+ * @param argv arguments.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+int main(int argc, char *argv[]) {
+    threads_count = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while ((opt = getopt(argc, argv, "g:t:")) != -1) {
+        if (opt == 'g' && atoi(optarg) > 0) {
+            games_count = atoi(optarg);
+        }
+        else if (opt == 't' && atoi(optarg) > 0) {
+            threads_count = atoi(optarg);
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-g games] [-t threads]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (threads_count > games_count) {
+        threads_count = games_count;
+    }
+    if (threads_count > MAX_THREADS) {
+        threads_count = MAX_THREADS;
+    }
+
+    snapshots = calloc(games_count, sizeof(Snapshot));
+    if (snapshots == NULL) {
+        ERROR_EXIT("calloc");
+    }
+    // boards on screen, kept between frames
+    unsigned char (*boards)[ROWS][COLUMNS] = calloc(games_count, sizeof(*boards));
+    if (boards == NULL) {
+        ERROR_EXIT("calloc");
+    }
+
+    atomic_store(&running, true);
+    int i;
+    for (i = 0; i < threads_count; i++) {
+        workers[i].first = i;
+        workers[i].step = threads_count;
+        if (pthread_create(&workers[i].thread, NULL, worker_routine, &workers[i]) != 0) {
+            ERROR_EXIT("pthread_create");
+        }
+    }
+
+    // half blocks are multibyte characters
+    setlocale(LC_ALL, "");
+    initscr();
+    curs_set(0);
+    noecho();
+    cbreak();
+    init_half_pairs();
+    bkgd(COLOR_PAIR(GUI_COLOR_DEFAULT));
+    timeout(1000 / WALL_FPS);
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (getch() != KEY_QUIT) {
+        int per_row = COLS / TILE_WIDTH;
+        int visible = per_row*((LINES - 1) / TILE_HEIGHT);
+        if (visible > games_count) {
+            visible = games_count;
+        }
+
+        long pieces = 0, games = 0;
+        for (i = 0; i < threads_count; i++) {
+            pieces += atomic_load_explicit(&workers[i].pieces, memory_order_relaxed);
+            games += atomic_load_explicit(&workers[i].games, memory_order_relaxed);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double seconds = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+        attrset(COLOR_PAIR(GUI_COLOR_DEFAULT));
+        erase();
+        mvprintw(0, 0, "TetrisC wall  %d games on %d threads, %d shown  %.0f blocks/s  %ld games over  (Q to quit)",
+                 games_count, threads_count, visible, pieces / seconds, games);
+
+        for (i = 0; i < visible; i++) {
+            read_snapshot(&snapshots[i], boards[i]);
+            draw_board(boards[i], 1 + (i / per_row)*TILE_HEIGHT, (i % per_row)*TILE_WIDTH);
+            // ask for the board of the next frame
+            atomic_store_explicit(&snapshots[i].requested, true, memory_order_relaxed);
+        }
+        refresh();
+    }
+
+    endwin();
+    atomic_store(&running, false);
+    for (i = 0; i < threads_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    free(boards);
+    free(snapshots);
+    return EXIT_SUCCESS;
+}
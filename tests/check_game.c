@@ -0,0 +1,803 @@
+/**
+ * @file check_game.c
+ * @brief Unit tests of a game: allocations, agreement of the compact state with the game, queue of the
+ * blocks, beam search, expectimax search, transposition table, rollouts, perfect-clear solver,
+ * shortest key sequences and the keys wasted on them, vectorised environment and the range of its
+ * arguments, time budget of the bot, and agreement of the kernels of the board features.
+ *
+ * The test is linked with --wrap=malloc, --wrap=calloc and --wrap=realloc, so that every allocation
+ * done by the game is counted.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ *
+ * @copyright Copyright © 2017 Luca Della Libera. All rights reserved.
+ */
+
+#include <check.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "shared.h"
+#include "field.h"
+#include "block.h"
+#include "game.h"
+#include "state.h"
+#include "feature.h"
+#include "bot.h"
+#include "beam.h"
+#include "expectimax.h"
+#include "rollout.h"
+#include "pool.h"
+#include "table.h"
+#include "solver.h"
+#include "finesse.h"
+#include "vec_env.h"
+
+// number of games
+#define GAMES 20
+
+// max number of blocks per game
+#define MAX_PIECES 200
+
+// number of random actions per game, in the comparison of the state with the game
+#define ACTIONS 2000
+
+// number of allocations since the start of the test
+static long allocations;
+
+// hits of the concurrent test of the table that do not match their key, per thread
+static long torn_reads[4];
+
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t count, size_t size);
+extern void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    allocations++;
+    return __real_realloc(ptr, size);
+}
+
+START_TEST(test_game_create) {
+    allocations = 0;
+    Game *game = create_game();
+    long count = allocations;
+    delete_game(game);
+    // the game, its areas and its blocks
+    ck_assert_int_eq(count, 1);
+}
+END_TEST
+
+START_TEST(test_game_running) {
+    Game *game = create_game();
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    Beam *beam = create_beam(&DEFAULT_WEIGHTS, 2, 2, 2);
+
+    allocations = 0;
+    int i, p;
+    for (i = 0; i < GAMES; i++) {
+        init_game(game, i % 2 == 0 ? OPT_GHOST_ON : OPT_GHOST_OFF, i);
+        // moves of a player
+        rotate_block_game(game);
+        move_block_game(game, LEFT);
+        move_block_game(game, RIGHT);
+        move_block_game(game, DOWN);
+        fall_block_game(game);
+        tick_game(game);
+        // then the bot or the planner, until the game is over
+        for (p = 0; p < MAX_PIECES; p++) {
+            if ((i % 4 < 2 ? play_block_bot(bot, game) : play_block_beam(beam, game)) == TICK_GAME_OVER) {
+                break;
+            }
+        }
+    }
+    long count = allocations;
+
+    delete_beam(beam);
+    delete_bot(bot);
+    delete_game(game);
+    ck_assert_int_eq(count, 0);
+}
+END_TEST
+
+START_TEST(test_state_lockstep) {
+    Game *game = create_game();
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    GameState state, packed;
+    unsigned int seed = 2017;
+    int i, a;
+    for (i = 0; i < GAMES; i++) {
+        int ghost = i % 2 == 0 ? OPT_GHOST_ON : OPT_GHOST_OFF;
+        init_game(game, ghost, i);
+        init_state(&state, ghost, i);
+        for (a = 0; a < ACTIONS; a++) {
+            // states are cleared with memset, so that they can be compared byte by byte
+            pack_state(&packed, game);
+            ck_assert_int_eq(memcmp(&packed, &state, sizeof(GameState)), 0);
+            // random moves, and placements of the bot, so that rows are deleted
+            int action = rand_r(&seed) % 8;
+            if (action == 0) {
+                rotate_block_game(game);
+                rotate_block_state(&state);
+            }
+            else if (action <= 3) {
+                ck_assert_int_eq(move_block_game(game, action - 1), move_block_state(&state, action - 1));
+            }
+            else if (action == 4) {
+                fall_block_game(game);
+                fall_block_state(&state);
+            }
+            else if (action == 5) {
+                Placement p = find_placement_bot(bot, game);
+                ck_assert_int_eq(place_block_game(game, p), place_block_state(&state, p));
+            }
+            else {
+                int result = tick_game(game);
+                ck_assert_int_eq(result, tick_state(&state));
+                if (result == TICK_GAME_OVER) {
+                    break;
+                }
+            }
+        }
+        ck_assert_int_eq(state.rows, game->rows);
+
+        // a headless game of the bot is the game of the bot
+        if (i % 4 != 0) {
+            continue;
+        }
+        init_game(game, ghost, i);
+        init_state(&state, ghost, i);
+        for (a = 0; a < MAX_PIECES; a++) {
+            int result = play_block_bot(bot, game);
+            ck_assert_int_eq(result, play_block_state_bot(bot, &state));
+            if (result == TICK_GAME_OVER) {
+                break;
+            }
+        }
+        ck_assert_int_eq(state.score, game->score);
+        ck_assert_int_eq(state.rows, game->rows);
+    }
+    delete_bot(bot);
+    delete_game(game);
+}
+END_TEST
+
+START_TEST(test_state_undo) {
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    GameState state, before;
+    Undo u;
+    Placement p;
+    long rows = 0;
+    int i, n;
+    for (i = 0; i < GAMES; i++) {
+        init_state(&state, i % 2 == 0 ? OPT_GHOST_ON : OPT_GHOST_OFF, i);
+        for (n = 0; n < MAX_PIECES; n++) {
+            // every placement is undone exactly, including the deleted rows
+            before = state;
+            for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+                for (p.shift = -COLUMNS / 2; p.shift <= COLUMNS / 2; p.shift++) {
+                    if (apply_placement_state(&state, p, &u)) {
+                        undo_placement_state(&state, &u);
+                    }
+                    ck_assert_int_eq(memcmp(&before, &state, sizeof(GameState)), 0);
+                }
+            }
+            // then move on with a placement of the bot
+            Placement best = {0, 0};
+            double best_value = -1e300;
+            for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+                for (p.shift = -COLUMNS / 2; p.shift <= COLUMNS / 2; p.shift++) {
+                    if (apply_placement_state(&state, p, &u)) {
+                        double value = u.result == TICK_GAME_OVER ? -1e200 : evaluate_state_bot(&state, u.cleared_count, &bot->weights);
+                        if (value > best_value) {
+                            best_value = value;
+                            best = p;
+                        }
+                        undo_placement_state(&state, &u);
+                    }
+                }
+            }
+            if (!apply_placement_state(&state, best, &u) || u.result == TICK_GAME_OVER) {
+                break;
+            }
+        }
+        rows += state.rows;
+    }
+    delete_bot(bot);
+    // the deletion of rows was undone too
+    ck_assert(rows > 0);
+}
+END_TEST
+
+START_TEST(test_state_queue) {
+    GameState state;
+    uint8_t types[BEAM_MAX_DEPTH], rots[BEAM_MAX_DEPTH];
+    Placement p = {0, 0};
+    Undo u;
+    int i, n;
+    for (i = 0; i < GAMES; i++) {
+        init_state(&state, OPT_GHOST_ON, i);
+        get_queue_state(&state, BEAM_MAX_DEPTH, types, rots);
+        // the queue is the sequence of the blocks that fall
+        for (n = 0; n < BEAM_MAX_DEPTH; n++) {
+            ck_assert(apply_placement_state(&state, p, &u));
+            if (u.result == TICK_GAME_OVER) {
+                break;
+            }
+            ck_assert_int_eq(state.type, types[n]);
+            ck_assert_int_eq(state.rot, rots[n]);
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_beam) {
+    Game *game = create_game(), *other = create_game();
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    Beam *narrow = create_beam(&DEFAULT_WEIGHTS, 1, 1, 1);
+    Beam *serial = create_beam(&DEFAULT_WEIGHTS, 8, 3, 1);
+    Beam *parallel = create_beam(&DEFAULT_WEIGHTS, 8, 3, 4);
+    Placement a, b;
+    int i, p;
+    for (i = 0; i < GAMES; i++) {
+        // a beam of one board and one block is the bot
+        init_game(game, OPT_GHOST_ON, i);
+        init_game(other, OPT_GHOST_ON, i);
+        for (p = 0; p < MAX_PIECES; p++) {
+            if (play_block_bot(bot, game) == TICK_GAME_OVER) {
+                break;
+            }
+            ck_assert_int_ne(play_block_beam(narrow, other), TICK_GAME_OVER);
+        }
+        ck_assert_int_eq(game->score, other->score);
+        ck_assert_int_eq(game->rows, other->rows);
+
+        // the result does not depend on the number of threads
+        init_game(game, OPT_GHOST_ON, i);
+        for (p = 0; p < MAX_PIECES / 20; p++) {
+            a = find_placement_beam(serial, game);
+            b = find_placement_beam(parallel, game);
+            ck_assert(a.rotations == b.rotations && a.shift == b.shift);
+            if (play_block_beam(serial, game) == TICK_GAME_OVER) {
+                break;
+            }
+        }
+    }
+    delete_beam(parallel);
+    delete_beam(serial);
+    delete_beam(narrow);
+    delete_bot(bot);
+    delete_game(other);
+    delete_game(game);
+}
+END_TEST
+
+START_TEST(test_expectimax) {
+    Game *game = create_game(), *other = create_game();
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    Expectimax *greedy = create_expectimax(&DEFAULT_WEIGHTS, 1, 1, 1, 0);
+    Expectimax *serial = create_expectimax(&DEFAULT_WEIGHTS, 3, 2, 1, 0);
+    Expectimax *parallel = create_expectimax(&DEFAULT_WEIGHTS, 3, 2, 4, 0);
+    Placement a, b;
+    int i, p;
+    for (i = 0; i < GAMES; i++) {
+        // a search of one block is the bot
+        init_game(game, OPT_GHOST_ON, i);
+        init_game(other, OPT_GHOST_ON, i);
+        for (p = 0; p < MAX_PIECES; p++) {
+            if (play_block_bot(bot, game) == TICK_GAME_OVER) {
+                break;
+            }
+            ck_assert_int_ne(play_block_expectimax(greedy, other), TICK_GAME_OVER);
+        }
+        ck_assert_int_eq(game->score, other->score);
+
+        // the result does not depend on the number of threads, and the search does not allocate
+        if (i % 4 != 0) {
+            continue;
+        }
+        init_game(game, OPT_GHOST_ON, i);
+        allocations = 0;
+        for (p = 0; p < MAX_PIECES / 20; p++) {
+            a = find_placement_expectimax(serial, game);
+            b = find_placement_expectimax(parallel, game);
+            ck_assert(a.rotations == b.rotations && a.shift == b.shift);
+            if (play_block_expectimax(serial, game) == TICK_GAME_OVER) {
+                break;
+            }
+        }
+        ck_assert_int_eq(allocations, 0);
+    }
+    delete_expectimax(parallel);
+    delete_expectimax(serial);
+    delete_expectimax(greedy);
+    delete_bot(bot);
+    delete_game(other);
+    delete_game(game);
+}
+END_TEST
+
+/**
+ * @brief Task of a pool: store and probe keys that share few slots, counting the hits that do not match their key.
+ *
+ * @param arg table pointer.
+ * @param id thread index.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static void hammer_table(void *arg, int id) {
+    Table *t = arg;
+    Placement p = {id % 4, -id};
+    double value;
+    long i;
+    for (i = 0; i < 100000; i++) {
+        long k = (i*7 + id) % 1000 + 1;
+        store_table(t, mix_hash_table(0, k), k, k % 8, p);
+        k = (i*13 + id) % 1000 + 1;
+        if (probe_table(t, mix_hash_table(0, k), &value, NULL, NULL) && value != k) {
+            torn_reads[id]++;
+        }
+    }
+}
+
+START_TEST(test_table) {
+    Table *t = create_table(4096);
+    Placement p = {3, -4}, q = {1, 2}, best;
+    double value;
+    int depth;
+    // as many entries as fit in the budget, a power of 2
+    ck_assert_uint_eq(get_size_table(t), 128);
+    uint64_t key = mix_hash_table(0, 1), other = key + get_size_table(t);
+    ck_assert(!probe_table(t, key, &value, NULL, NULL));
+    age_table(t);
+    store_table(t, key, -2.5, 3, p);
+    ck_assert(probe_table(t, key, &value, &depth, &best));
+    ck_assert(value == -2.5 && depth == 3 && best.rotations == 3 && best.shift == -4);
+    // a shallower entry does not replace a deeper one of the same search, but replaces one of a previous search
+    store_table(t, other, 1, 2, q);
+    ck_assert(!probe_table(t, other, &value, NULL, NULL));
+    age_table(t);
+    store_table(t, other, 1, 2, q);
+    ck_assert(probe_table(t, other, &value, NULL, &best));
+    ck_assert(!probe_table(t, key, &value, NULL, NULL));
+    delete_table(t);
+
+    // concurrent stores in the same slots are never read as another key
+    t = create_table(2048);
+    Pool *pool = create_pool(4);
+    memset(torn_reads, 0, sizeof(torn_reads));
+    run_pool(pool, hammer_table, t);
+    int i;
+    for (i = 0; i < 4; i++) {
+        ck_assert_int_eq(torn_reads[i], 0);
+    }
+    delete_pool(pool);
+    delete_table(t);
+}
+END_TEST
+
+START_TEST(test_rollout) {
+    Game *game = create_game();
+    Rollout *serial[2], *parallel[2];
+    Placement a, b;
+    int policy, i, p;
+    for (policy = ROLLOUT_RANDOM; policy <= ROLLOUT_GREEDY; policy++) {
+        serial[policy] = create_rollout(&DEFAULT_WEIGHTS, 4, 4, 3, policy, 1);
+        parallel[policy] = create_rollout(&DEFAULT_WEIGHTS, 4, 4, 3, policy, 3);
+    }
+    // the result does not depend on the number of threads, and the continuations do not allocate
+    for (i = 0; i < GAMES / 4; i++) {
+        init_game(game, OPT_GHOST_ON, i);
+        allocations = 0;
+        for (p = 0; p < MAX_PIECES / 20; p++) {
+            policy = p % 2;
+            a = find_placement_rollout(serial[policy], game);
+            b = find_placement_rollout(parallel[policy], game);
+            ck_assert(a.rotations == b.rotations && a.shift == b.shift);
+            if (play_block_rollout(serial[policy], game) == TICK_GAME_OVER) {
+                break;
+            }
+        }
+        ck_assert_int_eq(allocations, 0);
+    }
+    for (policy = ROLLOUT_RANDOM; policy <= ROLLOUT_GREEDY; policy++) {
+        delete_rollout(parallel[policy]);
+        delete_rollout(serial[policy]);
+    }
+    delete_game(game);
+}
+END_TEST
+
+START_TEST(test_solver) {
+    Solver *serial = create_solver(1, 1 << 20), *parallel = create_solver(4, 1 << 20);
+    GameState state, replay;
+    Placement a[SOLVER_MAX_PIECES], b[SOLVER_MAX_PIECES];
+    uint8_t types[3];
+    Undo u;
+    unsigned int seed = 2017;
+    int i, k, n, row, solved = 0;
+    // one I_SHORT fills the hole of the bottom row, and a block that does not fit the count has no solution
+    init_state(&state, OPT_GHOST_ON, 0);
+    state.board[ROWS - 1] = ((1 << COLUMNS) - 1) & ~7;
+    types[0] = I_SHORT;
+    ck_assert_int_eq(solve_solver(serial, &state, types, 1, a), 1);
+    types[0] = T;
+    ck_assert_int_eq(solve_solver(serial, &state, types, 1, a), -1);
+    ck_assert_int_eq(solve_solver(serial, &state, types, 0, a), -1);
+    state.board[ROWS - 1] = 0;
+    ck_assert_int_eq(solve_solver(serial, &state, types, 1, a), 0);
+    // the holes left by two blocks dropped on an empty board, which may or may not be filled by the same blocks
+    for (i = 0; i < 4*GAMES; i++) {
+        init_state(&state, OPT_GHOST_ON, i);
+        for (k = 0; k < 3; k++) {
+            types[k] = 1 + rand_r(&seed) % I_SHORT;
+        }
+        for (k = 0; k < 2; k++) {
+            spawn_block_state(&state, types[k], 0);
+            Placement p = {rand_r(&seed) % 4, rand_r(&seed) % (2*MAX_SHIFT + 1) - MAX_SHIFT};
+            apply_placement_state(&state, p, &u);
+        }
+        for (row = 0; row < ROWS; row++) {
+            if (state.board[row] != 0) {
+                state.board[row] ^= (1 << COLUMNS) - 1;
+            }
+        }
+        // the solution does not depend on the number of threads, and it empties the board
+        n = solve_solver(serial, &state, types, 3, a);
+        ck_assert_int_eq(solve_solver(parallel, &state, types, 3, b), n);
+        for (k = 0; k < n; k++) {
+            ck_assert(a[k].rotations == b[k].rotations && a[k].shift == b[k].shift);
+        }
+        if (n > 0) {
+            replay = state;
+            for (k = 0; k < n; k++) {
+                spawn_block_state(&replay, types[k], 0);
+                ck_assert(apply_placement_state(&replay, a[k], &u) && u.result == TICK_LOCKED);
+            }
+            for (row = 0; row < ROWS; row++) {
+                ck_assert_int_eq(replay.board[row], 0);
+            }
+            solved++;
+        }
+        ck_assert(get_nodes_solver(serial) > 0);
+    }
+    ck_assert(solved > 0);
+    delete_solver(parallel);
+    delete_solver(serial);
+}
+END_TEST
+
+START_TEST(test_finesse) {
+    Finesse *finesse = create_finesse();
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    GameState state, placed, pressed;
+    Placement p;
+    uint8_t keys[FINESSE_MAX_KEYS];
+    long hits, lookups;
+    int i, n, k, count;
+    for (i = 0; i < GAMES / 4; i++) {
+        init_state(&state, OPT_GHOST_ON, i);
+        for (n = 0; n < MAX_PIECES / 4; n++) {
+            // the keys reach the final position of every placement, with no more keys than the placement
+            for (p.rotations = 0; p.rotations < 4; p.rotations++) {
+                for (p.shift = -MAX_SHIFT; p.shift <= MAX_SHIFT; p.shift++) {
+                    placed = state;
+                    if (!place_block_state(&placed, p)) {
+                        ck_assert_int_eq(find_placement_keys_finesse(finesse, &state, p, keys), -1);
+                        continue;
+                    }
+                    count = find_placement_keys_finesse(finesse, &state, p, keys);
+                    ck_assert(count > 0 && count <= p.rotations + abs(p.shift) + 1);
+                    ck_assert_int_eq(keys[count - 1], FINESSE_DROP);
+                    pressed = state;
+                    for (k = 0; k < count; k++) {
+                        press_key_finesse(&pressed, keys[k]);
+                    }
+                    ck_assert(pressed.rot == placed.rot && pressed.row == placed.row && pressed.col == placed.col);
+                }
+            }
+            if (play_block_state_bot(bot, &state) == TICK_GAME_OVER) {
+                break;
+            }
+        }
+    }
+    // every placement of a block after the first one falls on a searched surface
+    get_stats_finesse(finesse, &hits, &lookups);
+    ck_assert(hits > lookups / 2);
+    delete_bot(bot);
+    delete_finesse(finesse);
+}
+END_TEST
+
+START_TEST(test_finesse_wasted) {
+    Finesse *finesse = create_finesse();
+    GameState state, placed;
+    // far from the spawn: a rotation and 3 moves left before the drop
+    Placement p = {1, -3};
+    uint8_t keys[FINESSE_MAX_KEYS];
+    int i, count;
+    for (i = 0; i < GAMES; i++) {
+        init_state(&state, OPT_GHOST_ON, i);
+        placed = state;
+        if (!place_block_state(&placed, p)) {
+            continue;
+        }
+        count = find_placement_keys_finesse(finesse, &state, p, keys);
+        ck_assert(count > 1);
+        // the keys are compared with the shortest sequence from the spawn, not from the final position
+        ck_assert_int_eq(count_wasted_keys_finesse(finesse, &state, placed.rot, placed.row, placed.col, count), 0);
+        ck_assert_int_eq(count_wasted_keys_finesse(finesse, &state, placed.rot, placed.row, placed.col, count + 3), 3);
+        ck_assert_int_eq(count_wasted_keys_finesse(finesse, &state, placed.rot, placed.row, placed.col, count - 1), 0);
+    }
+    delete_finesse(finesse);
+}
+END_TEST
+
+START_TEST(test_vec_env) {
+    int count = GAMES;
+    unsigned int seeds[GAMES], generators[GAMES];
+    int actions[GAMES];
+    GameState states[GAMES];
+    Undo undos[GAMES];
+    unsigned int seed = 2017;
+    int i, n, row, col, done = 0;
+    for (i = 0; i < count; i++) {
+        seeds[i] = generators[i] = i;
+        init_state(&states[i], OPT_GHOST_OFF, rand_r(&generators[i]));
+    }
+    // the trainer maps the shared memory on its own, and sees every step without copies
+    int fd;
+    uint8_t *buffer = map_shared_vec_env(count, &fd);
+    size_t size = get_buffer_size_vec_env(count);
+    uint8_t *trainer = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    ck_assert(trainer != MAP_FAILED);
+    uint8_t *serial_buffer = malloc(size);
+    VecEnv *parallel = create_vec_env(count, seeds, 3, buffer);
+    VecEnv *serial = create_vec_env(count, seeds, 1, serial_buffer);
+    Observation *obs = get_observations_vec_env(parallel);
+    float *rewards = get_rewards_vec_env(parallel);
+    uint8_t *dones = get_dones_vec_env(parallel);
+    allocations = 0;
+    for (n = 0; n < MAX_PIECES; n++) {
+        for (i = 0; i < count; i++) {
+            // random legal actions, which end games soon
+            do {
+                actions[i] = rand_r(&seed) % VEC_ENV_ACTIONS;
+            } while (!obs[i].legal[actions[i]]);
+            Placement p = {actions[i] / VEC_ENV_SHIFTS, actions[i] % VEC_ENV_SHIFTS - MAX_SHIFT};
+            ck_assert(apply_placement_state(&states[i], p, &undos[i]));
+        }
+        step_vec_env(parallel, actions);
+        step_vec_env(serial, actions);
+        // the games agree with the states, and the steps do not depend on the number of threads
+        for (i = 0; i < count; i++) {
+            ck_assert_int_eq(dones[i], undos[i].result == TICK_GAME_OVER);
+            if (dones[i]) {
+                done++;
+                init_state(&states[i], OPT_GHOST_OFF, rand_r(&generators[i]));
+            }
+            else {
+                ck_assert(rewards[i] == undos[i].cleared_count);
+            }
+            for (row = 0; row < ROWS; row++) {
+                for (col = 0; col < COLUMNS; col++) {
+                    ck_assert_int_eq(obs[i].cells[row][col] == CELL_FILLED, (states[i].board[row] >> col) & 1);
+                }
+            }
+            ck_assert_int_eq(obs[i].type, states[i].type);
+        }
+        ck_assert(memcmp(buffer, serial_buffer, size) == 0);
+        ck_assert(memcmp(buffer, trainer, size) == 0);
+    }
+    ck_assert_int_eq(allocations, 0);
+    ck_assert(done > 0);
+    delete_vec_env(serial);
+    delete_vec_env(parallel);
+    free(serial_buffer);
+    munmap(trainer, size);
+    unmap_shared_vec_env(buffer, count, fd);
+}
+END_TEST
+
+START_TEST(test_vec_env_range) {
+    // out of range: no games, too many games, no threads, too many threads
+    const int counts[] = {0, VEC_ENV_MAX_ENVS + 1, 1, 1};
+    const int threads[] = {1, 1, 0, POOL_MAX_THREADS + 1};
+    unsigned int seeds[1] = {0};
+    int fd, i, status;
+    void *buffer = map_shared_vec_env(1, &fd);
+    for (i = 0; i < 4; i++) {
+        pid_t pid = fork();
+        ck_assert(pid != -1);
+        if (pid == 0) {
+            freopen("/dev/null", "w", stderr);
+            create_vec_env(counts[i], seeds, threads[i], buffer);
+            _exit(EXIT_SUCCESS);
+        }
+        ck_assert(waitpid(pid, &status, 0) == pid);
+        ck_assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE);
+    }
+    unmap_shared_vec_env(buffer, 1, fd);
+}
+END_TEST
+
+/**
+ * @brief Measure the time of a search of the bot, spent by the calling thread.
+ *
+ * @param bot bot pointer.
+ * @param game game pointer.
+ * @param budget_nanos time budget of the search in nanoseconds, or -1 for a search without budget.
+ * @return time in nanoseconds: the other processes do not count, so that a loaded machine does not change it.
+ *
+ * @author Luca Della Libera (<luca310795@gmail.com>)
+ * @version 1.1
+ * @since 1.1
+ */
+static long elapsed_nanos(Bot *bot, Game *game, long budget_nanos) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    if (budget_nanos < 0) {
+        find_placement_bot(bot, game);
+    }
+    else {
+        find_placement_timed_bot(bot, game, budget_nanos);
+    }
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+    return (end.tv_sec - start.tv_sec)*1000000000L + end.tv_nsec - start.tv_nsec;
+}
+
+START_TEST(test_bot_budget) {
+    Game *game = create_game();
+    Bot *bot = create_bot(&DEFAULT_WEIGHTS);
+    Placement shallow, deep, timed;
+    long shallow_nanos, shallow_total = 0, timed_total = 0;
+    int i, p;
+    for (i = 0; i < GAMES; i++) {
+        init_game(game, OPT_GHOST_ON, i);
+        for (p = 0; p < MAX_PIECES / 4; p++) {
+            bot->depth = 1;
+            shallow = find_placement_bot(bot, game);
+            bot->depth = 2;
+            deep = find_placement_bot(bot, game);
+            // no time: the search of the falling block alone
+            timed = find_placement_timed_bot(bot, game, 0);
+            ck_assert(timed.rotations == shallow.rotations && timed.shift == shallow.shift);
+            // plenty of time: the deepest search
+            timed = find_placement_timed_bot(bot, game, 1000000000L);
+            ck_assert(timed.rotations == deep.rotations && timed.shift == deep.shift);
+            // half the time of the search of the falling block alone: the budget is spent by that search
+            bot->depth = 1;
+            shallow_nanos = elapsed_nanos(bot, game, -1);
+            bot->depth = 2;
+            shallow_total += shallow_nanos;
+            timed_total += elapsed_nanos(bot, game, shallow_nanos / 2);
+            if (play_block_bot(bot, game) == TICK_GAME_OVER) {
+                break;
+            }
+        }
+    }
+    // the budget counts from the call, so no deeper search follows once it is spent
+    ck_assert(timed_total < shallow_total*5 / 4);
+    delete_bot(bot);
+    delete_game(game);
+}
+END_TEST
+
+START_TEST(test_features_kernels) {
+    BoardBatch batch;
+    FeatureBatch expected, features;
+    Field field;
+    const Weights height = {1, 0, 0, 0, 0, 0, 0}, holes = {0, 0, 1, 0, 0, 0, 0}, bumpiness = {0, 0, 0, 1, 0, 0, 0};
+    unsigned int seed = 2017;
+    int kernel = get_kernel_feature();
+    int i, k, row, col;
+    for (i = 0; i < BATCH_SIZE; i++) {
+        // stacks of random height, 3 cells out of 4 filled
+        int top = rand_r(&seed) % (ROWS + 1);
+        for (row = 0; row < ROWS; row++) {
+            batch.rows[row][i] = 0;
+            for (col = 0; row >= top && col < COLUMNS; col++) {
+                if (rand_r(&seed) % 4 != 0) {
+                    batch.rows[row][i] |= 1 << col;
+                }
+            }
+        }
+    }
+    ck_assert(set_kernel_feature(KERNEL_SCALAR));
+    extract_features(&batch, BATCH_SIZE, &expected);
+
+    // the scalar kernel agrees with the features of a field
+    for (i = 0; i < BATCH_SIZE; i++) {
+        init_field(&field, ROWS, COLUMNS);
+        for (row = 0; row < ROWS; row++) {
+            for (col = 0; col < COLUMNS; col++) {
+                if (batch.rows[row][i] & 1 << col) {
+                    field.grid[row][col] = I;
+                }
+            }
+        }
+        ck_assert_int_eq(evaluate_field_bot(&field, 0, &height), expected.height[i]);
+        ck_assert_int_eq(evaluate_field_bot(&field, 0, &holes), expected.holes[i]);
+        ck_assert_int_eq(evaluate_field_bot(&field, 0, &bumpiness), expected.bumpiness[i]);
+    }
+
+    // every supported kernel agrees with the scalar one, also on a batch that is not a multiple of its lanes
+    for (k = KERNEL_SCALAR; k < KERNELS; k++) {
+        if (set_kernel_feature(k)) {
+            memset(&features, 0, sizeof(FeatureBatch));
+            extract_features(&batch, BATCH_SIZE - 3, &features);
+            for (i = 0; i < BATCH_SIZE - 3; i++) {
+                ck_assert_int_eq(features.height[i], expected.height[i]);
+                ck_assert_int_eq(features.holes[i], expected.holes[i]);
+                ck_assert_int_eq(features.bumpiness[i], expected.bumpiness[i]);
+                ck_assert_int_eq(features.row_transitions[i], expected.row_transitions[i]);
+                ck_assert_int_eq(features.col_transitions[i], expected.col_transitions[i]);
+                ck_assert_int_eq(features.wells[i], expected.wells[i]);
+            }
+        }
+    }
+    set_kernel_feature(kernel);
+}
+END_TEST
+
+static Suite *game_suite() {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("Game");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_game_create);
+    tcase_add_test(tc_core, test_game_running);
+    tcase_add_test(tc_core, test_state_lockstep);
+    tcase_add_test(tc_core, test_state_undo);
+    tcase_add_test(tc_core, test_state_queue);
+    tcase_add_test(tc_core, test_beam);
+    tcase_add_test(tc_core, test_expectimax);
+    tcase_add_test(tc_core, test_table);
+    tcase_add_test(tc_core, test_rollout);
+    tcase_add_test(tc_core, test_solver);
+    tcase_add_test(tc_core, test_finesse);
+    tcase_add_test(tc_core, test_finesse_wasted);
+    tcase_add_test(tc_core, test_vec_env);
+    tcase_add_test(tc_core, test_vec_env_range);
+    tcase_add_test(tc_core, test_bot_budget);
+    tcase_add_test(tc_core, test_features_kernels);
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main() {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = game_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}